@@ -1,9 +1,10 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart, sensor, cover, button, number, text_sensor, switch
+from esphome.components import uart, sensor, binary_sensor, cover, button, number, text_sensor, switch
 from esphome.const import CONF_ID, ICON_EMPTY, UNIT_EMPTY, CONF_NAME
 
 DEPENDENCIES = ["uart", "cover", "button"]
+AUTO_LOAD = ["sensor", "binary_sensor"]
 
 gatepro_ns = cg.esphome_ns.namespace("gatepro")
 GatePro = gatepro_ns.class_(
@@ -31,6 +32,50 @@ CONF_LEARN_STATUS = "txt_learn_status"
 CONF_PERMALOCK = "sw_permalock"
 CONF_INFRA1 = "sw_infra1"
 CONF_INFRA2 = "sw_infra2"
+CONF_RX_BUDGET = "rx_budget"
+CONF_TX_GAP = "tx_gap"
+CONF_CMD_TIMEOUT = "cmd_timeout"
+CONF_MAX_RETRIES = "max_retries"
+CONF_MAX_INFLIGHT = "max_inflight"
+CONF_POLL_FAST_INTERVAL = "poll_fast_interval"
+CONF_POLL_TRAVEL_INTERVAL = "poll_travel_interval"
+CONF_POLL_IDLE_INTERVAL = "poll_idle_interval"
+CONF_POLL_ACCEL_TIME = "poll_accel_time"
+CONF_POLL_DECEL_ZONE = "poll_decel_zone"
+CONF_INTERPOLATE = "interpolate_position"
+CONF_PREDICTIVE_STOP = "predictive_stop"
+CONF_PARAM_DEBOUNCE = "param_debounce"
+CONF_SOURCE_ID = "source_id"
+CONF_SAVE_INTERVAL = "save_interval"
+CONF_OPEN_TIME = "open_time"
+CONF_CLOSE_TIME = "close_time"
+CONF_CYCLES = "cycles"
+CONF_STOPS = "stops"
+CONF_AUTO_CLOSES = "auto_closes"
+CONF_STATUS_FIELDS = "status_fields"
+CONF_STATUS_RAW = "txt_status_raw"
+STATUS_FIELD_COUNT = 9
+CONF_PUBLISH_MIN_DELTA = "publish_min_delta"
+CONF_PUBLISH_MIN_INTERVAL = "publish_min_interval"
+CONF_PUBLISH_MAX_SILENCE = "publish_max_silence"
+CONF_OBSTRUCTION = "obstruction"
+CONF_STALL_TIMEOUT = "stall_timeout"
+CONF_OBSTRUCTION_STOP = "obstruction_stop"
+CONF_OBSTRUCTION_RETRIES = "obstruction_retries"
+CONF_OBSTRUCTION_RETRY_DELAY = "obstruction_retry_delay"
+CONF_POSITION_MODE = "position_mode"
+CONF_OPTIMISTIC_OPERATION = "optimistic_operation"
+CONF_MIN_POSITION_CHANGE = "min_position_change"
+
+POSITION_MODES = ["TARGET", "FULL_TRAVEL"]
+
+
+def validate_source_id(value):
+    value = cv.string_strict(value)
+    if not value.isalnum():
+        raise cv.Invalid("source_id may only contain letters and digits")
+    return value
+
 
 CONFIG_SCHEMA = cover.cover_schema(GatePro).extend(
     {
@@ -48,6 +93,47 @@ CONFIG_SCHEMA = cover.cover_schema(GatePro).extend(
         cv.Optional(CONF_PERMALOCK): cv.use_id(switch.Switch),
         cv.Optional(CONF_INFRA1): cv.use_id(switch.Switch),
         cv.Optional(CONF_INFRA2): cv.use_id(switch.Switch),
+        cv.Optional(CONF_OPEN_TIME): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_CLOSE_TIME): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_CYCLES): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_STOPS): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_AUTO_CLOSES): cv.use_id(sensor.Sensor),
+        # ACK RS field index -> sensor, published on change only
+        cv.Optional(CONF_STATUS_FIELDS): cv.Schema({
+            cv.Optional(f"field_{i}"): cv.use_id(sensor.Sensor) for i in range(STATUS_FIELD_COUNT)
+        }),
+        cv.Optional(CONF_STATUS_RAW): cv.use_id(text_sensor.TextSensor),
+        cv.Optional(CONF_OBSTRUCTION): cv.use_id(binary_sensor.BinarySensor),
+        cv.Optional(CONF_RX_BUDGET, default="10ms"): cv.All(
+            cv.positive_time_period_milliseconds, cv.Range(min=cv.TimePeriod(milliseconds=1))
+        ),
+        cv.Optional(CONF_TX_GAP, default="100ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_CMD_TIMEOUT, default="500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_RETRIES, default=2): cv.int_range(min=0, max=10),
+        cv.Optional(CONF_MAX_INFLIGHT, default=2): cv.int_range(min=1, max=4),
+        cv.Optional(CONF_POLL_FAST_INTERVAL, default="250ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_POLL_TRAVEL_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_POLL_IDLE_INTERVAL, default="10s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_POLL_ACCEL_TIME, default="2s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_POLL_DECEL_ZONE, default="15%"): cv.percentage,
+        cv.Optional(CONF_INTERPOLATE, default=True): cv.boolean,
+        cv.Optional(CONF_PREDICTIVE_STOP, default=True): cv.boolean,
+        cv.Optional(CONF_PARAM_DEBOUNCE, default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_SOURCE_ID, default="P00287D7"): validate_source_id,
+        cv.Optional(CONF_SAVE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_PUBLISH_MIN_DELTA, default="1%"): cv.percentage,
+        cv.Optional(CONF_PUBLISH_MIN_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+        # 0s disables the heartbeat
+        cv.Optional(CONF_PUBLISH_MAX_SILENCE, default="5min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_STALL_TIMEOUT, default="1500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_OBSTRUCTION_STOP, default=False): cv.boolean,
+        cv.Optional(CONF_OBSTRUCTION_RETRIES, default=0): cv.int_range(min=0, max=5),
+        cv.Optional(CONF_OBSTRUCTION_RETRY_DELAY, default="5s"): cv.positive_time_period_milliseconds,
+        # compile-time policies, the unused paths are left out of the build
+        cv.Optional(CONF_POSITION_MODE, default="TARGET"): cv.one_of(*POSITION_MODES, upper=True),
+        cv.Optional(CONF_OPTIMISTIC_OPERATION, default=False): cv.boolean,
+        # default depends on position_mode: 0% for target, 10% for full_travel
+        cv.Optional(CONF_MIN_POSITION_CHANGE): cv.percentage,
     }).extend(cv.COMPONENT_SCHEMA).extend(cv.polling_component_schema("60s")).extend(uart.UART_DEVICE_SCHEMA)
 
 async def to_code(config):
@@ -56,6 +142,35 @@ async def to_code(config):
     await cg.register_component(var, config)
     await cover.register_cover(var, config)
     await uart.register_uart_device(var, config)
+    cg.add(var.set_rx_budget(config[CONF_RX_BUDGET]))
+    cg.add(var.set_tx_gap(config[CONF_TX_GAP]))
+    cg.add(var.set_cmd_timeout(config[CONF_CMD_TIMEOUT]))
+    cg.add(var.set_max_retries(config[CONF_MAX_RETRIES]))
+    cg.add(var.set_max_inflight(config[CONF_MAX_INFLIGHT]))
+    cg.add(var.set_poll_fast_interval(config[CONF_POLL_FAST_INTERVAL]))
+    cg.add(var.set_poll_travel_interval(config[CONF_POLL_TRAVEL_INTERVAL]))
+    cg.add(var.set_poll_idle_interval(config[CONF_POLL_IDLE_INTERVAL]))
+    cg.add(var.set_poll_accel_time(config[CONF_POLL_ACCEL_TIME]))
+    cg.add(var.set_poll_decel_zone(config[CONF_POLL_DECEL_ZONE]))
+    cg.add(var.set_interpolate(config[CONF_INTERPOLATE]))
+    cg.add(var.set_predictive_stop(config[CONF_PREDICTIVE_STOP]))
+    cg.add(var.set_param_debounce(config[CONF_PARAM_DEBOUNCE]))
+    # baked into the command strings at compile time
+    cg.add_define("GATEPRO_SOURCE_ID", config[CONF_SOURCE_ID])
+    cg.add(var.set_save_interval(config[CONF_SAVE_INTERVAL]))
+    cg.add(var.set_publish_min_delta(config[CONF_PUBLISH_MIN_DELTA]))
+    cg.add(var.set_publish_min_interval(config[CONF_PUBLISH_MIN_INTERVAL]))
+    cg.add(var.set_publish_max_silence(config[CONF_PUBLISH_MAX_SILENCE]))
+    cg.add(var.set_stall_timeout(config[CONF_STALL_TIMEOUT]))
+    cg.add(var.set_obstruction_stop(config[CONF_OBSTRUCTION_STOP]))
+    cg.add(var.set_obstruction_retries(config[CONF_OBSTRUCTION_RETRIES]))
+    cg.add(var.set_obstruction_retry_delay(config[CONF_OBSTRUCTION_RETRY_DELAY]))
+    if config[CONF_POSITION_MODE] == "FULL_TRAVEL":
+      cg.add_define("GATEPRO_FULL_TRAVEL")
+    if config[CONF_OPTIMISTIC_OPERATION]:
+      cg.add_define("GATEPRO_OPTIMISTIC")
+    if CONF_MIN_POSITION_CHANGE in config:
+      cg.add(var.set_min_position_change(config[CONF_MIN_POSITION_CHANGE]))
 
     if CONF_LEARN in config:
         btn = await cg.get_variable(config[CONF_LEARN])
@@ -95,4 +210,30 @@ async def to_code(config):
       cg.add(var.set_sw_infra1(sw))
     if CONF_INFRA2 in config:
       sw = await cg.get_variable(config[CONF_INFRA2])
-      cg.add(var.set_sw_infra2(sw))
\ No newline at end of file
+      cg.add(var.set_sw_infra2(sw))
+    if CONF_OPEN_TIME in config:
+      sens = await cg.get_variable(config[CONF_OPEN_TIME])
+      cg.add(var.set_open_time_sensor(sens))
+    if CONF_CLOSE_TIME in config:
+      sens = await cg.get_variable(config[CONF_CLOSE_TIME])
+      cg.add(var.set_close_time_sensor(sens))
+    if CONF_CYCLES in config:
+      sens = await cg.get_variable(config[CONF_CYCLES])
+      cg.add(var.set_cycles_sensor(sens))
+    if CONF_STOPS in config:
+      sens = await cg.get_variable(config[CONF_STOPS])
+      cg.add(var.set_stops_sensor(sens))
+    if CONF_AUTO_CLOSES in config:
+      sens = await cg.get_variable(config[CONF_AUTO_CLOSES])
+      cg.add(var.set_auto_closes_sensor(sens))
+    if CONF_STATUS_FIELDS in config:
+      for i in range(STATUS_FIELD_COUNT):
+        if f"field_{i}" in config[CONF_STATUS_FIELDS]:
+          sens = await cg.get_variable(config[CONF_STATUS_FIELDS][f"field_{i}"])
+          cg.add(var.set_status_sensor(i, sens))
+    if CONF_STATUS_RAW in config:
+      txt = await cg.get_variable(config[CONF_STATUS_RAW])
+      cg.add(var.set_txt_status_raw(txt))
+    if CONF_OBSTRUCTION in config:
+      bs = await cg.get_variable(config[CONF_OBSTRUCTION])
+      cg.add(var.set_obstruction_sensor(bs))
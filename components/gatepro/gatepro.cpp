@@ -1,6 +1,9 @@
 #include "esphome/core/log.h"
 #include "gatepro.h"
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
 
 namespace esphome {
 namespace gatepro {
@@ -8,129 +11,492 @@ namespace gatepro {
 ////////////////////////////////////
 static const char* TAG = "gatepro";
 
+// NOTE: All values are most likely just indices, and thus are -1 offset from
+// the values of "leds" in the official user guide.
+static constexpr GateProParamDesc GATEPRO_PARAMS[] = {
+   {1, "auto close", 0, 7, &GatePro::auto_close_slider, nullptr},
+   {3, "speed", 0, 3, &GatePro::speed_slider, nullptr},
+   {4, "deceleration distance", 0, 4, &GatePro::decel_dist_slider, nullptr},
+   {5, "deceleration speed", 0, 3, &GatePro::decel_speed_slider, nullptr},
+   {6, "max amperage", 0, 8, &GatePro::max_amp_slider, nullptr},
+   {13, "infra 1", 0, 1, nullptr, &GatePro::sw_infra1},
+   {14, "infra 2", 0, 1, nullptr, &GatePro::sw_infra2},
+   {15, "stop terminal (permalock)", 0, 1, nullptr, &GatePro::sw_permalock},
+};
+
+static constexpr bool params_in_range() {
+   for (const auto &desc : GATEPRO_PARAMS) {
+      if (desc.index >= GATEPRO_PARAMS_COUNT || desc.min > desc.max) return false;
+   }
+   return true;
+}
+static_assert(params_in_range(), "GATEPRO_PARAMS entry out of range");
+
 ////////////////////////////////////////////
 // Helper / misc functions
 ////////////////////////////////////////////
+GateProTxPriority GatePro::tx_priority(GateProCmd cmd) {
+   switch (cmd) {
+      case GATEPRO_CMD_OPEN:
+      case GATEPRO_CMD_CLOSE:
+      case GATEPRO_CMD_STOP:
+      case GATEPRO_CMD_PED_OPEN:
+         return GATEPRO_TX_PRIO_MOTION;
+      case GATEPRO_CMD_READ_STATUS:
+         return GATEPRO_TX_PRIO_POLL;
+      default:
+         return GATEPRO_TX_PRIO_CONTROL;
+   }
+}
+
 void GatePro::queue_gatepro_cmd(GateProCmd cmd) {
-   this->tx_queue.push(GateProCmdMapping.at(cmd));
+   switch (this->tx_priority(cmd)) {
+      case GATEPRO_TX_PRIO_MOTION:
+         // a newer motion command supersedes whatever is still waiting
+         if (this->tx_motion_.has_value() && *this->tx_motion_ != cmd) {
+            ESP_LOGD(TAG, "Pending motion command superseded by: %s", GateProCmdMapping[cmd]);
+         }
+         this->tx_motion_ = cmd;
+         break;
+      case GATEPRO_TX_PRIO_POLL:
+         this->tx_poll_pending_ = true;
+         break;
+      case GATEPRO_TX_PRIO_CONTROL:
+         this->queue_frame(GateProTxFrame{cmd, {}});
+         break;
+   }
 }
 
-void GatePro::publish() {
-   // if position is unchanged
-   if (this->position_ == this->position) {
-      // ..and the after ticks are up, then don't update
-      if (this->after_tick == 0) {
-         return;
-      // ..but there are some after tick counts left, then update and take away 1 after tick
-      } else {
-         this->after_tick--;
+void GatePro::queue_frame(const GateProTxFrame &frame) {
+   this->tx_queue.push(frame);
+}
+
+////////////////////////////////////////////
+// In-flight command tracking
+////////////////////////////////////////////
+// prefix of the reply a command is acknowledged with, nullptr if it isn't (known to be) acked
+const char* GatePro::ack_prefix(GateProCmd cmd) {
+   switch (cmd) {
+      case GATEPRO_CMD_READ_STATUS:
+         return "ACK RS";
+      case GATEPRO_CMD_READ_PARAMS:
+         return "ACK RP";
+      case GATEPRO_CMD_WRITE_PARAMS:
+         return "ACK WP";
+      case GATEPRO_CMD_DEVINFO:
+         return "ACK READ DEVINFO";
+      case GATEPRO_CMD_READ_LEARN_STATUS:
+         return "ACK LEARN STATUS";
+      default:
+         return nullptr;
+   }
+}
+
+uint8_t GatePro::inflight_count() {
+   uint8_t n = 0;
+   for (auto &slot : this->inflight_) {
+      if (slot.active) n++;
+   }
+   return n;
+}
+
+bool GatePro::is_inflight(GateProCmd cmd) {
+   for (auto &slot : this->inflight_) {
+      if (slot.active && slot.frame.cmd == cmd) return true;
+   }
+   return false;
+}
+
+bool GatePro::track_inflight(const GateProTxFrame &frame, uint8_t attempts) {
+   for (auto &slot : this->inflight_) {
+      if (!slot.active) {
+         slot = {frame, millis(), this->inflight_seq_++, attempts, true, false};
+         return true;
       }
-   // otherwise update and reset after tick remaning count
+   }
+   return false;
+}
+
+void GatePro::match_ack(std::string_view frame) {
+   GateProInflight *match = nullptr;
+   for (auto &slot : this->inflight_) {
+      if (!slot.active) continue;
+      const char* prefix = this->ack_prefix(slot.frame.cmd);
+      if (frame.substr(0, strlen(prefix)) != prefix) continue;
+      if (match == nullptr || slot.seq < match->seq) match = &slot;
+   }
+   if (match == nullptr) {
+      return;
+   }
+   ESP_LOGV(TAG, "%s acknowledged after %u ms", this->ack_prefix(match->frame.cmd), millis() - match->sent_at);
+   match->active = false;
+}
+
+void GatePro::check_inflight() {
+   const uint32_t now = millis();
+   for (auto &slot : this->inflight_) {
+      if (!slot.active || slot.retry || now - slot.sent_at < this->cmd_timeout_) continue;
+      if (slot.attempts > this->max_retries_) {
+         ESP_LOGW(TAG, "No %s after %u attempts, giving up", this->ack_prefix(slot.frame.cmd), slot.attempts);
+         slot.active = false;
+         // slider changes are waiting for this read, try again after another debounce rather than lose them
+         if (slot.frame.cmd == GATEPRO_CMD_READ_PARAMS && this->params_flush_on_read_) {
+            this->params_flush_on_read_ = false;
+            this->set_timeout("params", this->param_debounce_, [this](){
+               this->flush_params();
+            });
+         }
+         continue;
+      }
+      ESP_LOGD(TAG, "No %s in %u ms, retrying", this->ack_prefix(slot.frame.cmd), this->cmd_timeout_);
+      slot.retry = true;
+   }
+}
+
+// publish policy: operation changes and the final resting position go out right away,
+// motion updates need a minimum change and spacing, and a heartbeat covers long silences
+void GatePro::publish() {
+   const uint32_t now = millis();
+   const uint32_t since = now - this->last_publish_;
+   const float delta = abs(this->position - this->position_);
+
+   bool due;
+   if (this->current_operation != this->published_operation_) {
+      due = true;
+   } else if (this->current_operation == cover::COVER_OPERATION_IDLE) {
+      due = delta > 0;
    } else {
-      this->position_ = this->position;
-      this->after_tick = this->after_tick_max;
+      due = delta >= this->publish_min_delta_ && since >= this->publish_min_interval_;
+   }
+   if (!due && (!this->publish_max_silence_ || since < this->publish_max_silence_)) {
+      return;
    }
 
+   this->position_ = this->position;
+   this->published_operation_ = this->current_operation;
+   this->last_publish_ = now;
    this->publish_state();
 }
 
 ////////////////////////////////////////////
 // GatePro logic functions
 ////////////////////////////////////////////
-void GatePro::process() {
-   if (!this->rx_queue.size()) {
-      return;
-   }
-   std::string msg = this->rx_queue.front();
-   this->rx_queue.pop();
+static bool starts_with(std::string_view str, std::string_view prefix) {
+   return str.substr(0, prefix.size()) == prefix;
+}
 
-   //ESP_LOGD(TAG, "UART RX: %s", (const char*)msg.c_str());
-   // example: ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n
-   //                          ^- percentage in hex
-   if (msg.substr(0, 6) == "ACK RS") {
-      // status only matters when in motion (operation not finished) 
-      if (this->operation_finished) {
-         return;
+// parse comma separated numbers in place, returns how many were parsed
+template<typename T>
+static size_t parse_fields(std::string_view in, int base, T *out, size_t max) {
+   const char *p = in.data();
+   const char *end = in.data() + in.size();
+   size_t n = 0;
+   while (p < end && n < max) {
+      auto res = std::from_chars(p, end, out[n], base);
+      if (res.ec != std::errc()) {
+         break;
       }
-      msg = msg.substr(16, 2);
-      int percentage = stoi(msg, 0, 16);
-      // percentage correction with known offset, if necessary
-      if (percentage > 100) {
-         percentage -= this->known_percentage_offset;
+      n++;
+      p = res.ptr;
+      if (p == end || *p != ',') {
+         break;
       }
-      this->position = (float)percentage / 100;
+      p++;
+   }
+   return n;
+}
+
+void GatePro::process(std::string_view frame) {
+   this->match_ack(frame);
+   if (frame.size() < 4) {
       return;
    }
 
-   // Read param example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0\r\n"
-   if (msg.substr(0, 6) == "ACK RP") {
-      this->parse_params(msg);
+   switch (frame[0]) {
+      // Event message from the motor
+      // example: $V1PKF0,17,Closed;src=0001
+      case '$':
+         if (starts_with(frame, "$V1PKF0,")) {
+            this->process_event(frame.substr(8));
+         }
+         return;
+      case 'A':
+         if (starts_with(frame, "ACK ")) {
+            break;
+         }
+         return;
+      default:
+         return;
+   }
+
+   std::string_view ack = frame.substr(4);
+   switch (ack.empty() ? 0 : ack[0]) {
+      case 'R':
+         // example: ACK RS:00,80,C4,C6,3E,16,FF,FF,FF
+         if (starts_with(ack, "RS:")) {
+            this->process_status(ack.substr(3));
+            return;
+         }
+         // Read param example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0
+         if (starts_with(ack, "RP,1:")) {
+            this->parse_params(ack.substr(5));
+            return;
+         }
+         // Devinfo example: ACK READ DEVINFO:P500BU,PS21053C,V01
+         if (starts_with(ack, "READ DEVINFO:")) {
+            std::string_view info = ack.substr(13).substr(0, GATEPRO_DEVINFO_SIZE - 1);
+            if (info != this->devinfo_) {
+               memcpy(this->devinfo_, info.data(), info.size());
+               this->devinfo_[info.size()] = 0;
+               this->state_dirty_ = true;
+            }
+            if (this->txt_devinfo) this->txt_devinfo->publish_state(this->devinfo_);
+            return;
+         }
+         return;
+      // ACK WP example: ACK WP,1
+      case 'W':
+         if (starts_with(ack, "WP")) {
+            ESP_LOGD(TAG, "Write params acknowledged");
+         }
+         return;
+      // Learn status example: ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0
+      case 'L':
+         if (starts_with(ack, "LEARN STATUS:")) {
+            if (this->txt_learn_status) this->txt_learn_status->publish_state(std::string(ack.substr(13)));
+         }
+         return;
+   }
+}
+
+// example: 00,80,C4,C6,3E,16,FF,FF,FF
+//                   ^- percentage in hex
+void GatePro::process_status(std::string_view fields) {
+   GateProStatus status{};
+   if (parse_fields(fields, 16, status.raw, GATEPRO_STATUS_FIELDS) < GATEPRO_STATUS_FIELDS) {
+      ESP_LOGW(TAG, "Malformed status");
       return;
    }
+   this->publish_status(status);
 
-   // ACK WP example: ACK WP,1\r\n
-   if (msg.substr(0, 6) == "ACK WP") {
-      ESP_LOGD(TAG, "Write params acknowledged");
+   int percentage = status.position;
+   // percentage correction with known offset, if necessary
+   if (percentage > 100) {
+      percentage -= this->known_percentage_offset;
+   }
+   const float pos = (float)percentage / 100;
+   // status only matters when in motion (operation not finished)..
+   if (this->operation_finished) {
+      this->sample_valid_ = false;
+      // ..unless the idle heartbeat caught the gate moving without an event (e.g. remote control)
+      if (abs(pos - this->position) >= this->acceptable_diff) {
+         ESP_LOGD(TAG, "Position changed to %.2f while idle", pos);
+         this->position = pos;
+         // the end stop of the last run no longer applies, don't let correction_after_operation() snap back to it
+         this->last_operation_ = cover::COVER_OPERATION_IDLE;
+         this->poll_boost_until_ = millis() + this->poll_accel_time_;
+      }
       return;
    }
+   if (this->current_operation != cover::COVER_OPERATION_IDLE) {
+      this->track_progress(pos);
+   }
+   this->record_sample(pos);
+   this->position = pos;
+   if (this->current_operation == cover::COVER_OPERATION_IDLE) {
+      this->finish_stop_run(pos);
+   }
+}
 
-   // Event message from the motor
-   // example: $V1PKF0,17,Closed;src=0001\r\n
-   if (msg.substr(0, 7) == "$V1PKF0") {
-      if (msg.substr(11, 7) == "Opening") {
-      this->operation_finished = false;
-      this->current_operation = cover::COVER_OPERATION_OPENING;
-      this->last_operation_ = cover::COVER_OPERATION_OPENING;
+// publish only the fields that changed since the last status
+void GatePro::publish_status(const GateProStatus &status) {
+   if (this->status_valid_ && memcmp(status.raw, this->last_status_.raw, GATEPRO_STATUS_FIELDS) == 0) {
       return;
+   }
+   for (uint8_t i = 0; i < GATEPRO_STATUS_FIELDS; i++) {
+      if (this->status_sensors_[i] && (!this->status_valid_ || status.raw[i] != this->last_status_.raw[i])) {
+         this->status_sensors_[i]->publish_state(status.raw[i]);
       }
-      if (msg.substr(11, 6) == "Opened") {
+   }
+
+   // raw dump, for working out what the unknown fields mean
+   char buf[GATEPRO_STATUS_FIELDS * 3];
+   char *pbuf = buf;
+   for (uint8_t i = 0; i < GATEPRO_STATUS_FIELDS; i++) {
+      pbuf += sprintf(pbuf, i ? ",%02X" : "%02X", status.raw[i]);
+   }
+   ESP_LOGD(TAG, "Status changed: %s", buf);
+   if (this->txt_status_raw) {
+      this->txt_status_raw->publish_state(buf);
+   }
+
+   this->last_status_ = status;
+   this->status_valid_ = true;
+}
+
+// example: 17,Closed;src=0001
+GateProEvent GatePro::parse_event(std::string_view body) {
+   // skip the event counter
+   size_t start = body.find(',');
+   if (start == std::string_view::npos) {
+      return GATEPRO_EVENT_UNKNOWN;
+   }
+   std::string_view name = body.substr(start + 1);
+   name = name.substr(0, name.find(';'));
+
+   switch (name.empty() ? 0 : name[0]) {
+      case 'O':
+         if (name == "Opening") return GATEPRO_EVENT_OPENING;
+         if (name == "Opened") return GATEPRO_EVENT_OPENED;
+         break;
+      case 'C':
+         if (name == "Closing") return GATEPRO_EVENT_CLOSING;
+         if (name == "Closed") return GATEPRO_EVENT_CLOSED;
+         break;
+      case 'A':
+         if (name == "AutoClosing") return GATEPRO_EVENT_AUTO_CLOSING;
+         break;
+      case 'S':
+         if (name == "Stopped") return GATEPRO_EVENT_STOPPED;
+         break;
+   }
+   return GATEPRO_EVENT_UNKNOWN;
+}
+
+void GatePro::process_event(std::string_view body) {
+   const GateProEvent event = this->parse_event(body);
+   this->record_event(event);
+   switch (event) {
+      case GATEPRO_EVENT_OPENING:
+         this->operation_finished = false;
+         this->sample_valid_ = false;
+         this->current_operation = cover::COVER_OPERATION_OPENING;
+         this->last_operation_ = cover::COVER_OPERATION_OPENING;
+         this->start_progress();
+         break;
+      case GATEPRO_EVENT_OPENED:
          this->operation_finished = true;
          this->target_position_ = 0.0f;
          this->current_operation = cover::COVER_OPERATION_IDLE;
-         return;
-      }
-      if (msg.substr(11, 7) == "Closing") {
-         this->operation_finished = false;
-         this->current_operation = cover::COVER_OPERATION_CLOSING;
-         this->last_operation_ = cover::COVER_OPERATION_CLOSING;
-         return;
-      }
-      if (msg.substr(11, 11) == "AutoClosing") {
+         // a STOP racing the end stop has nothing to learn from
+         this->stop_run_.active = false;
+         this->obstruction_attempts_ = 0;
+         this->clear_obstruction();
+         break;
+      case GATEPRO_EVENT_CLOSING:
+      case GATEPRO_EVENT_AUTO_CLOSING:
          this->operation_finished = false;
+         this->sample_valid_ = false;
          this->current_operation = cover::COVER_OPERATION_CLOSING;
          this->last_operation_ = cover::COVER_OPERATION_CLOSING;
-         return;
-      }
-      if (msg.substr(11, 6) == "Closed") {
+         this->start_progress();
+         break;
+      case GATEPRO_EVENT_CLOSED:
          this->operation_finished = true;
          this->target_position_ = 0.0f;
          this->current_operation = cover::COVER_OPERATION_IDLE;
-         return;
-      }
-      if (msg.substr(11, 7) == "Stopped") {
+         this->stop_run_.active = false;
+         this->obstruction_attempts_ = 0;
+         this->clear_obstruction();
+         break;
+      case GATEPRO_EVENT_STOPPED:
+         if (this->stop_run_.active && !this->stop_run_.stopped_at) {
+            this->stop_run_.stopped_at = millis();
+         } else if (this->current_operation != cover::COVER_OPERATION_IDLE) {
+            // stopped mid-travel without a STOP from us: overcurrent trip (max amp), photocell or remote.
+            // can't tell a trip from someone pressing stop, so report it but never restart the gate
+            this->report_obstruction("unexpected stop", false);
+         }
          this->target_position_ = 0.0f;
          this->current_operation = cover::COVER_OPERATION_IDLE;
-         return;
+         break;
+      case GATEPRO_EVENT_UNKNOWN:
+         ESP_LOGD(TAG, "Unknown event");
+         break;
+   }
+}
+
+////////////////////////////////////////////
+// Event journal
+////////////////////////////////////////////
+// time since the run that just ended started, 0 if it wasn't a clean start -> end run
+uint32_t GatePro::travel_time(GateProEvent start, GateProEvent alt_start) {
+   // newest entry is the end event itself
+   const GateProJournalEntry &end = this->journal_[(this->journal_head_ + GATEPRO_JOURNAL_SIZE - 1) % GATEPRO_JOURNAL_SIZE];
+   for (uint8_t i = 2; i <= this->journal_len_; i++) {
+      const GateProJournalEntry &entry = this->journal_[(this->journal_head_ + GATEPRO_JOURNAL_SIZE - i) % GATEPRO_JOURNAL_SIZE];
+      if (entry.event == start || entry.event == alt_start) {
+         return end.time - entry.time;
+      }
+      // interrupted or reversed on the way
+      if (entry.event != GATEPRO_EVENT_UNKNOWN) {
+         return 0;
       }
    }
+   return 0;
+}
 
-   // Devinfo example: ACK READ DEVINFO:P500BU,PS21053C,V01\r\n
-   if (msg.substr(0, 16) == "ACK READ DEVINFO") {
-      this->txt_devinfo->publish_state(msg.substr(17, msg.size() - (17 + 4)));
-      return;
+void GatePro::record_event(GateProEvent event) {
+   this->journal_[this->journal_head_] = {millis(), event};
+   this->journal_head_ = (this->journal_head_ + 1) % GATEPRO_JOURNAL_SIZE;
+   if (this->journal_len_ < GATEPRO_JOURNAL_SIZE) {
+      this->journal_len_++;
    }
 
-   // Devinfo example: ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n /
-   if (msg.substr(0, 16) == "ACK LEARN STATUS") {
-      this->txt_learn_status->publish_state(msg.substr(17, msg.size() - (17 + 4)));
-      return;
+   uint32_t time;
+   switch (event) {
+      case GATEPRO_EVENT_OPENING:
+         this->opened_since_closed_ = true;
+         return;
+      case GATEPRO_EVENT_OPENED:
+         time = this->travel_time(GATEPRO_EVENT_OPENING, GATEPRO_EVENT_OPENING);
+         if (time) {
+            ESP_LOGD(TAG, "Opened in %u ms", time);
+            if (this->open_time_sensor) this->open_time_sensor->publish_state(time / 1000.0f);
+         }
+         return;
+      case GATEPRO_EVENT_CLOSED:
+         time = this->travel_time(GATEPRO_EVENT_CLOSING, GATEPRO_EVENT_AUTO_CLOSING);
+         if (time) {
+            ESP_LOGD(TAG, "Closed in %u ms", time);
+            if (this->close_time_sensor) this->close_time_sensor->publish_state(time / 1000.0f);
+         }
+         // a cycle is complete once the gate closes after having been opened
+         if (this->opened_since_closed_) {
+            this->opened_since_closed_ = false;
+            this->cycles_++;
+            this->state_dirty_ = true;
+         }
+         break;
+      case GATEPRO_EVENT_STOPPED:
+         this->stops_++;
+         this->state_dirty_ = true;
+         break;
+      case GATEPRO_EVENT_AUTO_CLOSING:
+         this->auto_closes_++;
+         this->state_dirty_ = true;
+         break;
+      default:
+         return;
    }
+   this->publish_counters();
+}
+
+void GatePro::publish_counters() {
+   if (this->cycles_sensor) this->cycles_sensor->publish_state(this->cycles_);
+   if (this->stops_sensor) this->stops_sensor->publish_state(this->stops_);
+   if (this->auto_closes_sensor) this->auto_closes_sensor->publish_state(this->auto_closes_);
 }
 
 ////////////////////////////////////////////
 // Cover component logic functions
 ////////////////////////////////////////////
 void GatePro::control(const cover::CoverCall &call) {
+   // a user command takes over from any pending obstruction retry
+   this->cancel_timeout("obstruction_retry");
+   this->obstruction_attempts_ = 0;
+   this->clear_obstruction();
+
    if (call.get_stop()) {
       this->start_direction_(cover::COVER_OPERATION_IDLE);
       return;
@@ -141,8 +507,15 @@ void GatePro::control(const cover::CoverCall &call) {
       if (pos == this->position) {
          return;
       }
+      // in full travel mode a position only picks the direction, the gate always runs to the end stop
+      if (abs(pos - this->position) < this->min_pos_diff_) {
+         return;
+      }
       auto op = pos < this->position ? cover::COVER_OPERATION_CLOSING : cover::COVER_OPERATION_OPENING;
+#ifndef GATEPRO_FULL_TRAVEL
       this->target_position_ = pos;
+      this->target_operation_ = op;
+#endif
       this->start_direction_(op);
    }
 }
@@ -168,6 +541,19 @@ void GatePro::start_direction_(cover::CoverOperation dir) {
       default:
          return;
    }
+
+#ifdef GATEPRO_OPTIMISTIC
+   // show the motion right away instead of waiting for the motor's event,
+   // STOP still waits for Stopped so the stop run can be measured
+   if (dir != cover::COVER_OPERATION_IDLE) {
+      this->operation_finished = false;
+      // the last sample is from standstill, extrapolating it would run ahead of the gate
+      this->sample_valid_ = false;
+      this->current_operation = dir;
+      this->last_operation_ = dir;
+      this->start_progress();
+   }
+#endif
 }
 
 void GatePro::correction_after_operation() {
@@ -187,89 +573,455 @@ void GatePro::correction_after_operation() {
    }
 }
 
-void GatePro::stop_at_target_position() {
+// poll fast while the gate speeds up or approaches its destination, slower mid-travel
+// and only a heartbeat while idle
+uint32_t GatePro::poll_interval() {
+   const uint32_t now = millis();
+   if (this->current_operation == cover::COVER_OPERATION_IDLE) {
+      if ((int32_t) (this->poll_boost_until_ - now) > 0) {
+         return this->poll_fast_interval_;
+      }
+      return this->poll_idle_interval_;
+   }
+
+   if (now - this->motion_started_ < this->poll_accel_time_ || this->stall_suspect_) {
+      return this->poll_fast_interval_;
+   }
+
+   if (abs(this->position - this->destination()) < this->poll_decel_zone_) {
+      return this->poll_fast_interval_;
+   }
+   return this->poll_travel_interval_;
+}
+
+void GatePro::schedule_poll() {
+   const uint32_t now = millis();
+   // poll right away when motion starts / ends
+   if (this->current_operation != this->polled_operation_) {
+      this->polled_operation_ = this->current_operation;
+      if (this->current_operation != cover::COVER_OPERATION_IDLE) {
+         this->motion_started_ = now;
+      }
+      this->last_poll_ = now;
+      this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
+      return;
+   }
+
+   if (now - this->last_poll_ >= this->poll_interval()) {
+      this->last_poll_ = now;
+      this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
+   }
+}
+
+// where the current motion is going to end: the partial target if there's one, otherwise the end stop
+float GatePro::destination() {
    if (this->target_position_ &&
          this->target_position_ != cover::COVER_OPEN &&
          this->target_position_ != cover::COVER_CLOSED) {
-      const float diff = abs(this->position - this->target_position_);
-      if (diff < this->acceptable_diff) {
+      return this->target_position_;
+   }
+   return this->current_operation == cover::COVER_OPERATION_CLOSING ? cover::COVER_CLOSED : cover::COVER_OPEN;
+}
+
+////////////////////////////////////////////
+// Motion estimator
+////////////////////////////////////////////
+// learn the travel speed of the current direction from consecutive status samples
+void GatePro::record_sample(float pos) {
+   const uint32_t now = millis();
+   if (this->sample_valid_ && this->current_operation != cover::COVER_OPERATION_IDLE) {
+      const uint32_t dt = now - this->sample_time_;
+      const float moved = this->current_operation == cover::COVER_OPERATION_CLOSING ?
+         this->sample_position_ - pos : pos - this->sample_position_;
+      if (dt >= this->min_sample_dt && moved > 0) {
+         const float speed = moved * 1000.0f / dt;
+         float &learned = this->travel_speed_[this->dir_index(this->current_operation)];
+         learned = learned ? learned + this->speed_smoothing * (speed - learned) : speed;
+      }
+   }
+   this->sample_position_ = pos;
+   this->sample_time_ = now;
+   this->sample_valid_ = true;
+}
+
+// extrapolate from the last status sample with the learned speed, never past the destination
+float GatePro::estimate_position() {
+   if (!this->interpolate_ || !this->sample_valid_ ||
+         this->current_operation == cover::COVER_OPERATION_IDLE) {
+      return this->position;
+   }
+   const float speed = this->travel_speed_[this->dir_index(this->current_operation)];
+   if (!speed) {
+      return this->position;
+   }
+
+   const float moved = speed * (millis() - this->sample_time_) / 1000.0f;
+   if (this->current_operation == cover::COVER_OPERATION_CLOSING) {
+      return std::max(this->sample_position_ - moved, this->destination());
+   }
+   return std::min(this->sample_position_ + moved, this->destination());
+}
+
+////////////////////////////////////////////
+// Predictive stop
+////////////////////////////////////////////
+#ifndef GATEPRO_FULL_TRAVEL
+// how far the gate will still travel if STOP is decided on right now: at full speed while waiting
+// for the next TX slot and for the motor to act on the STOP (learned latency), then the learned coast
+float GatePro::stop_lead(cover::CoverOperation dir) {
+   const GateProStopStats &stats = this->stop_stats_[this->dir_index(dir)];
+   if (!this->predictive_stop_ || !stats.samples) {
+      return this->acceptable_diff;
+   }
+   const uint32_t since_tx = millis() - this->last_tx_;
+   const uint32_t tx_wait = since_tx < this->tx_gap_ ? this->tx_gap_ - since_tx : 0;
+   const float speed = this->travel_speed_[this->dir_index(dir)];
+   return std::max(speed * (tx_wait + stats.latency_ms) / 1000.0f + stats.overrun, 0.0f);
+}
+#endif
+
+void GatePro::begin_stop_run() {
+   if (this->current_operation == cover::COVER_OPERATION_IDLE) {
+      return;
+   }
+   this->stop_run_.active = true;
+   this->stop_run_.dir = this->current_operation;
+   this->stop_run_.sent_at = millis();
+   this->stop_run_.stopped_at = 0;
+   this->stop_run_.sent_position = this->estimate_position();
+}
+
+// first status after the Stopped event: the gate is at rest, learn from the run
+void GatePro::finish_stop_run(float pos) {
+   GateProStopRun &run = this->stop_run_;
+   if (!run.active || !run.stopped_at) {
+      return;
+   }
+   run.active = false;
+   // cut short by an obstruction, not a representative stop
+   if (this->obstructed_) {
+      return;
+   }
+
+   const float travelled = run.dir == cover::COVER_OPERATION_CLOSING ? run.sent_position - pos : pos - run.sent_position;
+   const float latency = run.stopped_at - run.sent_at;
+   // split into the part at travel speed until the Stopped event and the coast after it, so the lead
+   // follows a changed speed; the coast may come out negative, stop_lead() only clamps the sum
+   const float overrun = travelled - this->travel_speed_[this->dir_index(run.dir)] * latency / 1000.0f;
+   GateProStopStats &stats = this->stop_stats_[this->dir_index(run.dir)];
+   if (stats.samples) {
+      stats.latency_ms += this->stop_smoothing * (latency - stats.latency_ms);
+      stats.overrun += this->stop_smoothing * (overrun - stats.overrun);
+   } else {
+      stats.latency_ms = latency;
+      stats.overrun = overrun;
+   }
+   stats.samples++;
+   this->state_dirty_ = true;
+   ESP_LOGD(TAG, "Stop run (%s): travelled %.3f, latency %.0f ms, coast %.3f -> avg latency %.0f ms, avg coast %.3f",
+      run.dir == cover::COVER_OPERATION_CLOSING ? "closing" : "opening",
+      travelled, latency, overrun, stats.latency_ms, stats.overrun);
+}
+
+#ifndef GATEPRO_FULL_TRAVEL
+
+void GatePro::stop_at_target_position() {
+   if (!this->target_position_ ||
+         this->target_position_ == cover::COVER_OPEN ||
+         this->target_position_ == cover::COVER_CLOSED) {
+      return;
+   }
+   // STOP is waiting for its TX slot or on its way already
+   if (this->tx_motion_.has_value() && *this->tx_motion_ == GATEPRO_CMD_STOP) {
+      return;
+   }
+   if (this->stop_run_.active && millis() - this->stop_run_.sent_at < this->cmd_timeout_) {
+      return;
+   }
+
+   const float pos = this->estimate_position();
+   // not moving the way it was told to (yet), only the plain proximity check applies
+   if (this->current_operation != this->target_operation_) {
+      if (abs(pos - this->target_position_) < this->acceptable_diff) {
          this->make_call().set_command_stop().perform();
       }
+      return;
+   }
+
+   // issue STOP early enough for the gate to come to rest at the target
+   const float remaining = this->current_operation == cover::COVER_OPERATION_CLOSING ?
+      pos - this->target_position_ : this->target_position_ - pos;
+   if (remaining <= this->stop_lead(this->current_operation)) {
+      this->make_call().set_command_stop().perform();
+   }
+}
+#endif
+
+////////////////////////////////////////////
+// Obstruction detection
+////////////////////////////////////////////
+// every status sample during travel: advancing, standing still or going backwards
+void GatePro::track_progress(float pos) {
+   const float moved = this->current_operation == cover::COVER_OPERATION_CLOSING ?
+      this->progress_position_ - pos : pos - this->progress_position_;
+   if (moved > 0) {
+      this->progress_position_ = pos;
+      this->progress_time_ = millis();
+      this->stall_suspect_ = false;
+   } else if (moved <= -this->acceptable_diff) {
+      this->report_obstruction("moving backwards", true);
+   } else {
+      this->stall_suspect_ = true;
+   }
+}
+
+void GatePro::start_progress() {
+   this->progress_position_ = this->position;
+   this->progress_time_ = millis();
+   this->stall_suspect_ = false;
+}
+
+void GatePro::check_stall() {
+   if (!this->stall_suspect_ || this->obstructed_ ||
+         this->current_operation == cover::COVER_OPERATION_IDLE || this->stop_run_.active) {
+      return;
+   }
+   const uint32_t now = millis();
+   // still speeding up, or slowing down into the destination
+   if (now - this->motion_started_ < this->poll_accel_time_ ||
+         abs(this->progress_position_ - this->destination()) < this->acceptable_diff) {
+      return;
+   }
+   if (now - this->progress_time_ >= this->stall_timeout_) {
+      this->report_obstruction("stalled", true);
    }
 }
 
+void GatePro::report_obstruction(const char *reason, bool retry) {
+   if (this->obstructed_) {
+      return;
+   }
+   this->obstructed_ = true;
+   this->stall_suspect_ = false;
+   this->obstruction_dir_ = this->current_operation;
+   this->obstruction_target_ = this->target_position_;
+   ESP_LOGW(TAG, "Obstruction while %s at %.2f: %s",
+      this->obstruction_dir_ == cover::COVER_OPERATION_CLOSING ? "closing" : "opening", this->position, reason);
+   if (this->obstruction_sensor) this->obstruction_sensor->publish_state(true);
+
+   // halts a stalled motor, and cancels the auto-close countdown after a trip
+   if (this->obstruction_stop_) {
+      this->queue_gatepro_cmd(GATEPRO_CMD_STOP);
+   }
+   if (retry && this->obstruction_attempts_ < this->obstruction_retries_) {
+      this->obstruction_attempts_++;
+      this->set_timeout("obstruction_retry", this->obstruction_retry_delay_, [this](){
+         this->retry_after_obstruction();
+      });
+   }
+}
+
+void GatePro::clear_obstruction() {
+   if (!this->obstructed_) {
+      return;
+   }
+   this->obstructed_ = false;
+   if (this->obstruction_sensor) this->obstruction_sensor->publish_state(false);
+}
+
+// resume the interrupted run, unless the gate was moved in the meantime
+void GatePro::retry_after_obstruction() {
+   if (!this->obstructed_ || this->current_operation != cover::COVER_OPERATION_IDLE) {
+      return;
+   }
+   ESP_LOGD(TAG, "Retrying after obstruction (%u/%u)", this->obstruction_attempts_, this->obstruction_retries_);
+   this->clear_obstruction();
+   this->target_position_ = this->obstruction_target_;
+   this->target_operation_ = this->obstruction_dir_;
+   this->start_direction_(this->obstruction_dir_);
+}
+
 ////////////////////////////////////////////
 // UART operations
 ////////////////////////////////////////////
+size_t GateProLineFramer::space() {
+   // move the unconsumed remainder to the front so the free space is contiguous
+   if (this->head_) {
+      size_t len = this->tail_ - this->head_;
+      if (len) {
+         std::memmove(this->buf_, this->buf_ + this->head_, len);
+      }
+      this->scan_ -= this->head_;
+      this->head_ = 0;
+      this->tail_ = len;
+   }
+   return GATEPRO_RX_BUFFER_SIZE - this->tail_;
+}
+
+bool GateProLineFramer::next(std::string_view &frame) {
+   while (this->scan_ < this->tail_) {
+      auto *cr = (uint8_t*) std::memchr(this->buf_ + this->scan_, '\r', this->tail_ - this->scan_);
+      if (cr == nullptr) {
+         this->scan_ = this->tail_;
+         break;
+      }
+      size_t pos = cr - this->buf_;
+      // '\r' is the last byte so far, wait for the rest (unless the buffer is full, see below)
+      if (pos + 1 == this->tail_) {
+         this->scan_ = pos;
+         break;
+      }
+      // lone '\r', keep looking
+      if (this->buf_[pos + 1] != '\n') {
+         this->scan_ = pos + 1;
+         continue;
+      }
+      frame = std::string_view((const char*) this->buf_ + this->head_, pos - this->head_);
+      this->head_ = pos + 2;
+      this->scan_ = this->head_;
+      return true;
+   }
+
+   // buffer is full without a complete delimiter, this is garbage: drop it
+   // (also when it ends in '\r', the '\n' would never fit and RX would stall)
+   if (this->head_ == 0 && this->tail_ == GATEPRO_RX_BUFFER_SIZE) {
+      this->overflows_++;
+      ESP_LOGW(TAG, "RX buffer full without a delimiter, dropped (%u overflows so far)", this->overflows_);
+      const bool pending_cr = this->buf_[this->tail_ - 1] == '\r';
+      this->reset();
+      // keep a trailing '\r' so its '\n' ends the garbage instead of sticking to the next frame
+      if (pending_cr) {
+         this->buf_[this->tail_++] = '\r';
+      }
+   }
+   return false;
+}
+
 void GatePro::read_uart() {
    // check if anything on UART buffer
    int available = this->available();
    if (!available) {
       return;
    }
-   
-   // read the whole buffer into our own buffer
-   // (if there's remainder from previous msgs, concatenate)
-   uint8_t* bytes = new byte[available];
-   this->read_array(bytes, available);
-   this->msg_buff += this->convert(bytes, available);
 
-   // find delimiter, thus a whole msg, send it to processor, then remove from buffer and keep remainder (if any)
-   size_t pos = this->msg_buff.find(this->delimiter);
-   if (pos != std::string::npos) {
-      std::string sub = this->msg_buff.substr(0, pos + this->delimiter_length);
-      this->rx_queue.push(sub);
-      ESP_LOGD(TAG, "UART RX[%d]: %s", this->rx_queue.size(), sub.c_str());
-      this->msg_buff = this->msg_buff.substr(pos + this->delimiter_length); //, this->msg_buff.length() - pos);
+   // read straight into the framer, whatever doesn't fit stays in the UART buffer until next time
+   size_t len = std::min((size_t) available, this->rx_framer_.space());
+   if (!len) {
+      return;
+   }
+   this->read_array(this->rx_framer_.tail(), len);
+   this->rx_framer_.commit(len);
+}
+
+void GatePro::send_frame(const GateProTxFrame &frame) {
+   const char* out = frame.payload[0] ? frame.payload : GateProCmdMapping[frame.cmd];
+   this->write_str(out);
+   this->write_str(this->tx_delimiter.c_str());
+   this->last_tx_ = millis();
+   ESP_LOGD(TAG, "UART TX[%zu]: %s", this->tx_queue.size(), out);
+
+   if (frame.cmd == GATEPRO_CMD_STOP) {
+      this->begin_stop_run();
    }
 }
 
 void GatePro::write_uart() {
+   this->check_inflight();
+
+   // frames are paced by the inter-frame gap, not by the polling interval
+   if (millis() - this->last_tx_ < this->tx_gap_) {
+      return;
+   }
+
+   // motion is never held back by outstanding requests
+   if (this->tx_motion_.has_value()) {
+      this->send_frame(GateProTxFrame{*this->tx_motion_, {}});
+      this->tx_motion_.reset();
+      return;
+   }
+
+   // a param write must land before anything else is read
+   if (this->is_inflight(GATEPRO_CMD_WRITE_PARAMS)) {
+      return;
+   }
+
+   // resend timed out requests first
+   for (auto &slot : this->inflight_) {
+      if (slot.active && slot.retry) {
+         slot.retry = false;
+         slot.attempts++;
+         slot.sent_at = millis();
+         this->send_frame(slot.frame);
+         return;
+      }
+   }
+
+   const uint8_t inflight = this->inflight_count();
+   if (inflight >= (this->boot_burst_ ? GATEPRO_MAX_INFLIGHT : this->max_inflight_)) {
+      return;
+   }
+   if (this->tx_queue.empty()) {
+      this->boot_burst_ = false;
+   }
+
    if (this->tx_queue.size()) {
-      std::string tmp = this->tx_queue.front();
-      tmp += this->tx_delimiter;
-      const char* out = tmp.c_str();
-      this->write_str(out);
-      ESP_LOGD(TAG, "UART TX[%d]: %s", this->tx_queue.size(), out);
+      const GateProTxFrame &frame = this->tx_queue.front();
+      if (frame.cmd == GATEPRO_CMD_WRITE_PARAMS && inflight) {
+         return;
+      }
+      if (this->ack_prefix(frame.cmd) != nullptr) {
+         this->track_inflight(frame, 1);
+      }
+      this->send_frame(frame);
       this->tx_queue.pop();
+      return;
+   }
+
+   // no point asking for the status again while the previous answer is on its way
+   if (this->tx_poll_pending_ && !this->is_inflight(GATEPRO_CMD_READ_STATUS)) {
+      this->tx_poll_pending_ = false;
+      const GateProTxFrame frame{GATEPRO_CMD_READ_STATUS, {}};
+      this->track_inflight(frame, 1);
+      this->send_frame(frame);
    }
 }
 
-std::string GatePro::convert(uint8_t* bytes, size_t len) {
-	std::string res;
-	char buf[5];
-	for (size_t i = 0; i < len; i++) {
-		if (bytes[i] == 7) {
-			res += "\\a";
-		} else if (bytes[i] == 8) {
-			res += "\\b";
-		} else if (bytes[i] == 9) {
-			res += "\\t";
-		} else if (bytes[i] == 10) {
-			res += "\\n";
-		} else if (bytes[i] == 11) {
-			res += "\\v";
-		} else if (bytes[i] == 12) {
-			res += "\\f";
-		} else if (bytes[i] == 13) {
-			res += "\\r";
-		} else if (bytes[i] == 27) {
-			res += "\\e";
-		} else if (bytes[i] == 34) {
-			res += "\\\"";
-		} else if (bytes[i] == 39) {
-			res += "\\'";
-		} else if (bytes[i] == 92) {
-			res += "\\\\";
-		} else if (bytes[i] < 32 || bytes[i] > 127) {
-			sprintf(buf, "\\x%02X", bytes[i]);
-			res += buf;
-		} else {
-			res += bytes[i];
-		}
-	}
-	//ESP_LOGD(TAG, "%s", res.c_str());
-	return res;
+// escape control / non-printable bytes for logging, output is always null terminated
+size_t GatePro::escape(std::string_view in, char *out, size_t out_len) {
+   static const char hex[] = "0123456789ABCDEF";
+   size_t o = 0;
+   for (uint8_t c : in) {
+      char esc = 0;
+      switch (c) {
+         case 7: esc = 'a'; break;
+         case 8: esc = 'b'; break;
+         case 9: esc = 't'; break;
+         case 10: esc = 'n'; break;
+         case 11: esc = 'v'; break;
+         case 12: esc = 'f'; break;
+         case 13: esc = 'r'; break;
+         case 27: esc = 'e'; break;
+         case 34: esc = '"'; break;
+         case 39: esc = '\''; break;
+         case 92: esc = '\\'; break;
+      }
+      if (esc) {
+         if (o + 2 >= out_len) break;
+         out[o++] = '\\';
+         out[o++] = esc;
+      } else if (c < 32 || c > 127) {
+         if (o + 4 >= out_len) break;
+         out[o++] = '\\';
+         out[o++] = 'x';
+         out[o++] = hex[c >> 4];
+         out[o++] = hex[c & 0x0F];
+      } else {
+         if (o + 1 >= out_len) break;
+         out[o++] = c;
+      }
+   }
+   out[o] = 0;
+   return o;
 }
 
 
@@ -277,74 +1029,128 @@ std::string GatePro::convert(uint8_t* bytes, size_t len) {
 // Paramater functions
 ////////////////////////////////////////////
 void GatePro::set_param(int idx, int val) {
-   ESP_LOGD(TAG, "Initiating setting param %d to %d", idx, val);
+   if (idx < 0 || idx >= GATEPRO_PARAMS_COUNT) {
+      return;
+   }
+   ESP_LOGD(TAG, "Param %d set to %d, pending", idx, val);
+   this->params_pending_[idx] = val;
+   this->params_dirty_ |= 1UL << idx;
    this->param_no_pub = true;
-   this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
 
-   this->paramTaskQueue.push(
-      [this, idx, val](){
-         ESP_LOGD(TAG, "Initiating set speed");
-         this->params[idx] = val;
-         this->write_params();
-      });
+   // every change within the window restarts it, they all end up in a single write
+   this->set_timeout("params", this->param_debounce_, [this](){
+      this->flush_params();
+   });
+}
+
+void GatePro::on_param_change(const GateProParamDesc &desc, int value) {
+   const uint32_t bit = 1UL << desc.index;
+   // a change waiting for the debounce is what the new value has to be compared with
+   if (this->params_dirty_ & bit) {
+      if (this->params_pending_[desc.index] == value) {
+         return;
+      }
+      // moved back to what the gate already has: nothing left to write for it
+      if (this->params_valid_ && this->params[desc.index] == value) {
+         ESP_LOGD(TAG, "Param %d back to %d, dropped", desc.index, value);
+         this->params_dirty_ &= ~bit;
+         if (!this->params_dirty_) {
+            this->cancel_timeout("params");
+            this->param_no_pub = false;
+         }
+         return;
+      }
+   } else if (this->params_valid_ && this->params[desc.index] == value) {
+      return;
+   }
+   if (value < desc.min || value > desc.max) {
+      ESP_LOGW(TAG, "%s: %d is out of range (%u-%u)", desc.name, value, desc.min, desc.max);
+      return;
+   }
+   this->set_param(desc.index, value);
+}
+
+void GatePro::flush_params() {
+   if (!this->params_dirty_) {
+      return;
+   }
+   // nothing current to build the frame from yet, write as soon as the params are in
+   if (!this->params_confirmed_) {
+      this->params_flush_on_read_ = true;
+      this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
+      return;
+   }
+
+   for (size_t i = 0; i < GATEPRO_PARAMS_COUNT; i++) {
+      if (this->params_dirty_ & (1UL << i)) {
+         this->params[i] = this->params_pending_[i];
+      }
+   }
+   this->params_dirty_ = 0;
+   this->param_no_pub = false;
+   this->write_params();
 }
 
 void GatePro::publish_params() {
-   if (!this->param_no_pub) {
-      if (this->speed_slider) this->speed_slider->publish_state(this->params[3]);
-      if (this->decel_dist_slider) this->decel_dist_slider->publish_state(this->params[4]);
-      if (this->decel_speed_slider) this->decel_speed_slider->publish_state(this->params[5]);
-      if (this->max_amp_slider) this->max_amp_slider->publish_state(this->params[6]);
-      if (this->auto_close_slider) this->auto_close_slider->publish_state(this->params[1]);
-      if (this->sw_permalock) this->sw_permalock->publish_state(this->params[15]);
-      if (this->sw_infra1) this->sw_infra1->publish_state(this->params[13]);
-      if (this->sw_infra2) this->sw_infra2->publish_state(this->params[14]);
+   if (this->param_no_pub || !this->params_valid_) {
+      return;
+   }
+   for (const auto &desc : GATEPRO_PARAMS) {
+      const uint8_t value = this->params[desc.index];
+      if (desc.number && this->*desc.number) (this->*desc.number)->publish_state(value);
+      if (desc.sw && this->*desc.sw) (this->*desc.sw)->publish_state(value);
    }
 }
 
-void GatePro::parse_params(std::string msg) {
-   this->params.clear();
-   // example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0\r\n"
-   //                   ^-9  
-   msg = msg.substr(9, 33);
-   size_t start = 0;
-   size_t end;
+// example: 1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0
+void GatePro::parse_params(std::string_view fields) {
+   uint8_t parsed[GATEPRO_PARAMS_COUNT];
+   const size_t n = parse_fields(fields, 10, parsed, GATEPRO_PARAMS_COUNT);
+   if (n != GATEPRO_PARAMS_COUNT) {
+      ESP_LOGW(TAG, "Expected %d params, got %zu", GATEPRO_PARAMS_COUNT, n);
+      return;
+   }
+   // ACK RP comes with every read, only a real change is worth saving
+   if (!this->params_valid_ || !std::equal(parsed, parsed + n, this->params.begin())) {
+      this->state_dirty_ = true;
+   }
+   std::copy(parsed, parsed + n, this->params.begin());
+   this->params_valid_ = true;
+   this->params_confirmed_ = true;
 
-   // efficiently split on ','
-   while((end = msg.find(',', start)) != std::string::npos) {
-      this->params.push_back(stoi(msg.substr(start, end - start)));
-      start = end + 1;
+   // deceleration distance changes how far the gate coasts after STOP, what was learned is void
+   if (this->params[4] != this->learned_decel_dist_) {
+      if (this->learned_decel_dist_ >= 0) {
+         ESP_LOGD(TAG, "Deceleration distance changed, resetting stop statistics");
+      }
+      this->learned_decel_dist_ = this->params[4];
+      this->stop_stats_[0] = GateProStopStats{};
+      this->stop_stats_[1] = GateProStopStats{};
+      this->state_dirty_ = true;
    }
-   this->params.push_back(stoi(msg.substr(start)));
 
-   ESP_LOGD(TAG, "Parsed current params:", this->params.size());
-   for (size_t i = 0; i < this->params.size(); ++i) {
-      ESP_LOGD(TAG, "  [%zu] = %d", i, this->params[i]);
+   ESP_LOGD(TAG, "Parsed current params:");
+   for (const auto &desc : GATEPRO_PARAMS) {
+      ESP_LOGD(TAG, "  [%u] %s = %u", desc.index, desc.name, this->params[desc.index]);
    }
 
    this->publish_params();
 
-   // write new params if any task is up
-   while (!this->paramTaskQueue.empty()) {
-      auto task = this->paramTaskQueue.front();
-      this->paramTaskQueue.pop();
-      task();
-      this->param_no_pub = false;
+   // changes were waiting for the first read
+   if (this->params_flush_on_read_) {
+      this->params_flush_on_read_ = false;
+      this->flush_params();
    }
 }
 
 void GatePro::write_params() {
-   std::string msg = "WP,1:";
-   for (size_t i = 0; i < this->params.size(); i++) {
-      msg += to_string(this->params[i]);
-      if (i != this->params.size() -1) {
-         msg += ",";
-      }
+   GateProTxFrame frame{GATEPRO_CMD_WRITE_PARAMS, {}};
+   size_t len = snprintf(frame.payload, sizeof(frame.payload), "%s", GateProCmdMapping[GATEPRO_CMD_WRITE_PARAMS]);
+   for (size_t i = 0; i < GATEPRO_PARAMS_COUNT && len < sizeof(frame.payload); i++) {
+      len += snprintf(frame.payload + len, sizeof(frame.payload) - len, i ? ",%d" : "%d", this->params[i]);
    }
-   //msg += ";src=P00287D7";
-   std::strcpy(this->params_cmd, msg.c_str());
-   ESP_LOGD(TAG, "BUILT PARAMS: %s", this->params_cmd);
-   this->tx_queue.push(this->params_cmd);
+   ESP_LOGD(TAG, "BUILT PARAMS: %s", frame.payload);
+   this->queue_frame(frame);
 
    // read params again just to update frontend and make sure :)
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
@@ -363,13 +1169,94 @@ cover::CoverTraits GatePro::get_traits() {
    return traits;
 }
 
+////////////////////////////////////////////
+// Fast boot
+////////////////////////////////////////////
+void GatePro::restore_state() {
+   this->pref_ = global_preferences->make_preference<GateProSavedState>(
+      this->get_object_id_hash() ^ GATEPRO_STATE_VERSION, true);
+   GateProSavedState state{};
+   if (!this->pref_.load(&state)) {
+      ESP_LOGD(TAG, "No saved state");
+      return;
+   }
+   this->saved_state_ = state;
+
+   this->position = state.position;
+   this->position_ = state.position;
+   this->last_publish_ = millis();
+   this->last_operation_ = (cover::CoverOperation) state.last_operation;
+   // stopped halfway: there's no end stop for correction_after_operation() to snap to
+   if (state.position > cover::COVER_CLOSED && state.position < cover::COVER_OPEN) {
+      this->last_operation_ = cover::COVER_OPERATION_IDLE;
+   }
+   if (state.params_valid) {
+      std::copy(state.params, state.params + GATEPRO_PARAMS_COUNT, this->params.begin());
+      this->params_valid_ = true;
+      this->learned_decel_dist_ = this->params[4];
+      this->publish_params();
+   }
+   state.devinfo[GATEPRO_DEVINFO_SIZE - 1] = 0;
+   memcpy(this->devinfo_, state.devinfo, GATEPRO_DEVINFO_SIZE);
+   if (this->devinfo_[0] && this->txt_devinfo) {
+      this->txt_devinfo->publish_state(this->devinfo_);
+   }
+   for (int i = 0; i < 2; i++) {
+      this->travel_speed_[i] = state.travel_speed[i];
+      this->stop_stats_[i].latency_ms = state.stop_latency_ms[i];
+      this->stop_stats_[i].overrun = state.stop_overrun[i];
+      this->stop_stats_[i].samples = state.stop_samples[i];
+   }
+   this->cycles_ = state.cycles;
+   this->stops_ = state.stops;
+   this->auto_closes_ = state.auto_closes;
+   this->publish_counters();
+   ESP_LOGD(TAG, "Restored position %.2f, params %s, devinfo '%s'",
+      this->position, YESNO(this->params_valid_), this->devinfo_);
+   this->publish_state(false);
+}
+
+void GatePro::save_state() {
+   GateProSavedState state{};
+   state.position = this->position;
+   state.last_operation = this->last_operation_;
+   std::copy(this->params.begin(), this->params.end(), state.params);
+   state.params_valid = this->params_valid_;
+   memcpy(state.devinfo, this->devinfo_, GATEPRO_DEVINFO_SIZE);
+   for (int i = 0; i < 2; i++) {
+      state.travel_speed[i] = this->travel_speed_[i];
+      state.stop_latency_ms[i] = this->stop_stats_[i].latency_ms;
+      state.stop_overrun[i] = this->stop_stats_[i].overrun;
+      state.stop_samples[i] = this->stop_stats_[i].samples;
+   }
+   state.cycles = this->cycles_;
+   state.stops = this->stops_;
+   state.auto_closes = this->auto_closes_;
+
+   this->state_dirty_ = false;
+   this->last_save_ = millis();
+   // nothing changed, spare the flash
+   if (memcmp(&state, &this->saved_state_, sizeof(state)) == 0) {
+      return;
+   }
+   if (this->pref_.save(&state)) {
+      this->saved_state_ = state;
+      ESP_LOGD(TAG, "State saved");
+   }
+}
+
 void GatePro::setup() {
    ESP_LOGD(TAG, "Setting up GatePro component..");
    this->last_operation_ = cover::COVER_OPERATION_CLOSING;
    this->current_operation = cover::COVER_OPERATION_IDLE;
    this->operation_finished = true;
-   this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
    this->target_position_ = 0.0f;
+   this->restore_state();
+
+   // confirm everything with the motor in one pipelined burst, status first
+   this->boot_burst_ = true;
+   this->queue_frame(GateProTxFrame{GATEPRO_CMD_READ_STATUS, {}});
+   this->last_poll_ = millis();
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
    this->queue_gatepro_cmd(GATEPRO_CMD_DEVINFO);
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_LEARN_STATUS);
@@ -393,100 +1280,100 @@ void GatePro::setup() {
       });
    }
    
-   if (speed_slider) {
-      this->speed_slider->add_on_state_callback([this](int value){
-         if (this->params[3] == value) {
-            return;
-         }
-         this->set_param(3, value);
-      });
-   }
-
-   if (decel_dist_slider) {
-      this->decel_dist_slider->add_on_state_callback([this](int value){
-         if (this->params[4] == value) {
-            return;
-         }
-         this->set_param(4, value);
-      });
-   }
-
-   if (decel_speed_slider) {
-      this->decel_speed_slider->add_on_state_callback([this](int value){
-         if (this->params[5] == value) {
-            return;
-         }
-         this->set_param(5, value);
-      });
-   }
-
-   if (max_amp_slider) {
-      this->max_amp_slider->add_on_state_callback([this](int value){
-         if (this->params[6] == value) {
-            return;
-         }
-         this->set_param(6, value);
-      });
+   for (const auto &desc : GATEPRO_PARAMS) {
+      if (desc.number && this->*desc.number) {
+         (this->*desc.number)->add_on_state_callback([this, &desc](float value){
+            this->on_param_change(desc, (int) value);
+         });
+      }
+      if (desc.sw && this->*desc.sw) {
+         (this->*desc.sw)->add_on_state_callback([this, &desc](bool state){
+            this->on_param_change(desc, state ? 1 : 0);
+         });
+      }
    }
+}
 
-   if (auto_close_slider) {
-      this->auto_close_slider->add_on_state_callback([this](int value){
-         if (this->params[1] == value) {
-            return;
-         }
-         this->set_param(1, value);
-      });
+void GatePro::update() {
+   // smooth out the staircase between status samples
+   if (this->current_operation != cover::COVER_OPERATION_IDLE) {
+      this->position = this->estimate_position();
    }
+   this->correction_after_operation();
 
-   if (sw_permalock) {
-      this->sw_permalock->add_on_state_callback([this](bool state){
-         if (this->params[15] == state) {
-            return;
-         }
-         this->set_param(15, state ? 1 : 0);
-      });
+   // only persist a gate at rest, and not more often than save_interval
+   if (this->current_operation == cover::COVER_OPERATION_IDLE &&
+         (this->state_dirty_ || this->position != this->saved_state_.position) &&
+         millis() - this->last_save_ >= this->save_interval_) {
+      this->save_state();
    }
+}
 
-   if (sw_infra1) {
-      this->sw_infra1->add_on_state_callback([this](bool state){
-         if (this->params[13] == state) {
-            return;
-         }
-         this->set_param(13, state ? 1 : 0);
-      });
-   }
+void GatePro::loop() {
+   // frame and dispatch everything received so far in one go,
+   // but stop reading once the budget is used up so a burst can't starve others
+   // (the stop checks and the TX lanes below always run, a queued STOP mustn't wait for the burst)
+   const uint32_t start = millis();
+   do {
+      this->read_uart();
 
-   if (sw_infra2) {
-      this->sw_infra2->add_on_state_callback([this](bool state){
-         if (this->params[14] == state) {
-            return;
+      std::string_view frame;
+      while (this->rx_framer_.next(frame)) {
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+         char buf[GATEPRO_RX_BUFFER_SIZE + 1];
+         this->escape(frame, buf, sizeof(buf));
+         ESP_LOGD(TAG, "UART RX: %s", buf);
+#endif
+         this->process(frame);
+         if (millis() - start >= this->rx_budget_) {
+            break;  // the outer loop's budget check ends reading too
          }
-         this->set_param(14, state ? 1 : 0);
-      });
-   }
-}
+      }
+   } while (this->available() && millis() - start < this->rx_budget_);
 
-void GatePro::update() {
-   this->publish();
+   this->check_stall();
+#ifndef GATEPRO_FULL_TRAVEL
    this->stop_at_target_position();
-
+#endif
+   this->publish();
+   this->schedule_poll();
    this->write_uart();
-
-   if (this->current_operation != cover::COVER_OPERATION_IDLE) {
-      this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
-   }
-
-   this->correction_after_operation();
-}
-
-void GatePro::loop() {
-   // keep reading uart for changes
-   this->read_uart();
-   this->process();
 }
 
 void GatePro::dump_config(){
    ESP_LOGCONFIG(TAG, "GatePro sensor dump config");
+   ESP_LOGCONFIG(TAG, "  RX budget: %u ms", this->rx_budget_);
+   ESP_LOGCONFIG(TAG, "  RX overflows: %u", this->rx_framer_.overflows());
+   ESP_LOGCONFIG(TAG, "  TX gap: %u ms", this->tx_gap_);
+   ESP_LOGCONFIG(TAG, "  Command timeout: %u ms, retries: %u, max in-flight: %u",
+      this->cmd_timeout_, this->max_retries_, this->max_inflight_);
+   ESP_LOGCONFIG(TAG, "  Status poll: fast %u ms, travel %u ms, idle %u ms",
+      this->poll_fast_interval_, this->poll_travel_interval_, this->poll_idle_interval_);
+   ESP_LOGCONFIG(TAG, "  Fast poll: first %u ms of motion, last %.0f%% of travel",
+      this->poll_accel_time_, this->poll_decel_zone_ * 100);
+   ESP_LOGCONFIG(TAG, "  Interpolate position: %s", YESNO(this->interpolate_));
+#ifdef GATEPRO_FULL_TRAVEL
+   ESP_LOGCONFIG(TAG, "  Position mode: full travel");
+#else
+   ESP_LOGCONFIG(TAG, "  Position mode: target");
+   ESP_LOGCONFIG(TAG, "  Predictive stop: %s", YESNO(this->predictive_stop_));
+#endif
+#ifdef GATEPRO_OPTIMISTIC
+   ESP_LOGCONFIG(TAG, "  Optimistic operation: YES");
+#else
+   ESP_LOGCONFIG(TAG, "  Optimistic operation: NO");
+#endif
+   ESP_LOGCONFIG(TAG, "  Min position change: %.0f%%", this->min_pos_diff_ * 100);
+   ESP_LOGCONFIG(TAG, "  Obstruction: stall timeout %u ms, stop: %s, retries: %u (after %u ms)",
+      this->stall_timeout_, YESNO(this->obstruction_stop_), this->obstruction_retries_, this->obstruction_retry_delay_);
+   ESP_LOGCONFIG(TAG, "  Param debounce: %u ms", this->param_debounce_);
+   ESP_LOGCONFIG(TAG, "  Save interval: %u ms", this->save_interval_);
+   ESP_LOGCONFIG(TAG, "  Publish: min delta %.0f%%, min interval %u ms, max silence %u ms",
+      this->publish_min_delta_ * 100, this->publish_min_interval_, this->publish_max_silence_);
+   for (uint8_t i = 0; i < GATEPRO_STATUS_FIELDS; i++) {
+      LOG_SENSOR("  ", "Status field", this->status_sensors_[i]);
+   }
+   LOG_TEXT_SENSOR("  ", "Raw status", this->txt_status_raw);
 }
 
 }  // namespace gatepro
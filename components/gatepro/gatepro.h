@@ -1,12 +1,16 @@
 #pragma once
 
-#include <map>
+#include <array>
 #include <vector>
+#include <string_view>
 #include "esphome.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/components/cover/cover.h"
 #include "esphome/components/sensor/sensor.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/button/button.h"
 #include "esphome/components/number/number.h"
@@ -30,23 +34,179 @@ enum GateProCmd : uint8_t {
    GATEPRO_CMD_RESTORE, // untested
    GATEPRO_CMD_PED_OPEN, // untested
    GATEPRO_CMD_READ_FUNCTION, // untested
-};  
-
-const std::map<GateProCmd, const char*> GateProCmdMapping = {
-   {GATEPRO_CMD_OPEN, "FULL OPEN;src=P00287D7"},
-   {GATEPRO_CMD_CLOSE, "FULL CLOSE;src=P00287D7"},
-   {GATEPRO_CMD_STOP, "STOP;src=P00287D7"},
-   {GATEPRO_CMD_READ_STATUS, "RS;src=P00287D7"},
-   {GATEPRO_CMD_READ_PARAMS, "RP,1:;src=P00287D7"},
-   {GATEPRO_CMD_WRITE_PARAMS, "WP,1:"},
-   {GATEPRO_CMD_LEARN, "AUTO LEARN;src=P00287D7"},
-   {GATEPRO_CMD_DEVINFO, "READ DEVINFO;src=P00287D7"},
-   {GATEPRO_CMD_READ_LEARN_STATUS, "READ LEARN STATUS;src=P00287D7"},
-   {GATEPRO_CMD_REMOTE_LEARN, "REMOTE LEARN;src=P00287D7"},
-   {GATEPRO_CMD_CLEAR_REMOTE_LEARN, "CLEAR REMOTE LEARN;src=P00287D7"},
-   {GATEPRO_CMD_RESTORE, "RESTORE;src=P00287D7"},
-   {GATEPRO_CMD_PED_OPEN, "PED OPEN;src=P00287D7"},
-   {GATEPRO_CMD_READ_FUNCTION, "READ FUNCTION;src=P00287D7"},
+   GATEPRO_CMD_COUNT,
+};
+
+// events reported by the motor in $V1PKF0 frames
+enum GateProEvent : uint8_t {
+   GATEPRO_EVENT_OPENING,
+   GATEPRO_EVENT_OPENED,
+   GATEPRO_EVENT_CLOSING,
+   GATEPRO_EVENT_CLOSED,
+   GATEPRO_EVENT_STOPPED,
+   GATEPRO_EVENT_AUTO_CLOSING,
+   GATEPRO_EVENT_UNKNOWN,
+};
+
+// source id appended to the commands, set by source_id in cover.py
+#ifndef GATEPRO_SOURCE_ID
+#define GATEPRO_SOURCE_ID "P00287D7"
+#endif
+#define GATEPRO_SRC ";src=" GATEPRO_SOURCE_ID
+
+// compile-time policies, set by position_mode / optimistic_operation in cover.py
+// GATEPRO_FULL_TRAVEL: a position only picks the direction, the gate always runs to the end stop
+// GATEPRO_OPTIMISTIC: OPEN / CLOSE show up right away instead of waiting for the motor's event
+
+// indexed by GateProCmd, so it must follow the order of the enum
+static constexpr const char *const GateProCmdMapping[] = {
+   "FULL OPEN" GATEPRO_SRC,          // GATEPRO_CMD_OPEN
+   "FULL CLOSE" GATEPRO_SRC,         // GATEPRO_CMD_CLOSE
+   "STOP" GATEPRO_SRC,               // GATEPRO_CMD_STOP
+   "RS" GATEPRO_SRC,                 // GATEPRO_CMD_READ_STATUS
+   "RP,1:" GATEPRO_SRC,              // GATEPRO_CMD_READ_PARAMS
+   "WP,1:",                          // GATEPRO_CMD_WRITE_PARAMS
+   "AUTO LEARN" GATEPRO_SRC,         // GATEPRO_CMD_LEARN
+   "READ DEVINFO" GATEPRO_SRC,       // GATEPRO_CMD_DEVINFO
+   "READ LEARN STATUS" GATEPRO_SRC,  // GATEPRO_CMD_READ_LEARN_STATUS
+   "REMOTE LEARN" GATEPRO_SRC,       // GATEPRO_CMD_REMOTE_LEARN
+   "CLEAR REMOTE LEARN" GATEPRO_SRC, // GATEPRO_CMD_CLEAR_REMOTE_LEARN
+   "RESTORE" GATEPRO_SRC,            // GATEPRO_CMD_RESTORE
+   "PED OPEN" GATEPRO_SRC,           // GATEPRO_CMD_PED_OPEN
+   "READ FUNCTION" GATEPRO_SRC,      // GATEPRO_CMD_READ_FUNCTION
+};
+static_assert(sizeof(GateProCmdMapping) / sizeof(GateProCmdMapping[0]) == GATEPRO_CMD_COUNT,
+   "GateProCmdMapping must have an entry for every GateProCmd");
+
+// TX lanes, served strictly in this order
+enum GateProTxPriority : uint8_t {
+   GATEPRO_TX_PRIO_MOTION,  // STOP / OPEN / CLOSE, only the latest one is kept
+   GATEPRO_TX_PRIO_CONTROL, // params, devinfo, learning.. FIFO
+   GATEPRO_TX_PRIO_POLL,    // status polling, duplicates coalesced
+};
+
+#define GATEPRO_TX_PAYLOAD_SIZE 64
+// number of fields in ACK RP / WP
+#define GATEPRO_PARAMS_COUNT 17
+
+// a frame on its way out, commands built at runtime (WP) carry their own copy of the payload
+struct GateProTxFrame {
+   GateProCmd cmd;
+   char payload[GATEPRO_TX_PAYLOAD_SIZE];  // empty: use the command table
+};
+
+// commands waiting for their ACK, upper bound for max_inflight
+#define GATEPRO_MAX_INFLIGHT 4
+
+struct GateProInflight {
+   GateProTxFrame frame;
+   uint32_t sent_at;
+   uint32_t seq;        // send order, the oldest match is acknowledged first
+   uint8_t attempts;
+   bool active;
+   bool retry;          // timed out, resend when the TX slot frees up
+};
+
+// what a STOP costs in one direction, learned from previous runs
+struct GateProStopStats {
+   float latency_ms{0.0f};   // STOP sent -> Stopped event
+   float overrun{0.0f};      // distance coasted after the Stopped event
+   uint16_t samples{0};
+};
+
+// the STOP currently being measured
+struct GateProStopRun {
+   bool active{false};
+   cover::CoverOperation dir{cover::COVER_OPERATION_IDLE};
+   uint32_t sent_at{0};
+   uint32_t stopped_at{0};
+   float sent_position{0.0f};
+};
+
+#define GATEPRO_RX_BUFFER_SIZE 256
+#define GATEPRO_DELIMITER "\r\n"
+
+// Fixed-capacity receive buffer that cuts raw "\r\n" terminated frames out of the UART stream.
+// Bytes are written straight into the buffer, consumed bytes are compacted away lazily, so
+// the frames handed out are contiguous views and nothing ever touches the heap.
+// A frame view stays valid until the next call to space().
+class GateProLineFramer {
+   public:
+      // contiguous free space at the tail (compacts consumed bytes first)
+      size_t space();
+      uint8_t *tail() { return this->buf_ + this->tail_; }
+      void commit(size_t len) { this->tail_ += len; }
+      // next complete frame without its delimiter, false if there's none yet
+      bool next(std::string_view &frame);
+      void reset() { this->head_ = this->tail_ = this->scan_ = 0; }
+      uint32_t overflows() const { return this->overflows_; }
+
+   protected:
+      uint8_t buf_[GATEPRO_RX_BUFFER_SIZE];
+      size_t head_{0};  // first unconsumed byte
+      size_t tail_{0};  // one past the last received byte
+      size_t scan_{0};  // delimiter search resumes here
+      uint32_t overflows_{0};
+};
+
+#define GATEPRO_STATUS_FIELDS 9
+
+// ACK RS frame, example: ACK RS:00,80,C4,C6,3E,16,FF,FF,FF
+// only the position is known for sure, the other fields are exposed as is for telemetry / reverse engineering
+union GateProStatus {
+   uint8_t raw[GATEPRO_STATUS_FIELDS];
+   struct {
+      uint8_t field0;
+      uint8_t field1;
+      uint8_t field2;
+      uint8_t position;  // percentage, sometimes with +128 (see known_percentage_offset)
+      uint8_t field4;
+      uint8_t field5;
+      uint8_t field6;
+      uint8_t field7;
+      uint8_t field8;
+   } __attribute__((packed));
+};
+static_assert(sizeof(GateProStatus) == GATEPRO_STATUS_FIELDS, "GateProStatus must map the RS fields 1:1");
+
+#define GATEPRO_JOURNAL_SIZE 32
+
+// a motor event as it was received
+struct GateProJournalEntry {
+   uint32_t time;
+   GateProEvent event;
+};
+
+#define GATEPRO_DEVINFO_SIZE 40
+// bump whenever GateProSavedState changes
+#define GATEPRO_STATE_VERSION 3
+
+// everything needed to come back from a reboot without waiting for the motor
+struct GateProSavedState {
+   float position;
+   uint8_t last_operation;
+   uint8_t params[GATEPRO_PARAMS_COUNT];
+   bool params_valid;
+   char devinfo[GATEPRO_DEVINFO_SIZE];
+   float travel_speed[2];
+   float stop_latency_ms[2];
+   float stop_overrun[2];
+   uint16_t stop_samples[2];
+   uint32_t cycles;
+   uint32_t stops;
+   uint32_t auto_closes;
+} __attribute__((packed));
+
+class GatePro;
+
+// a motor parameter and the frontend entity it is bound to (one of number / sw)
+struct GateProParamDesc {
+   uint8_t index;
+   const char *name;
+   uint8_t min;
+   uint8_t max;
+   number::Number *GatePro::*number;
+   switch_::Switch *GatePro::*sw;
 };
 
 class GatePro : public cover::Cover, public PollingComponent, public uart::UARTDevice {
@@ -61,14 +221,32 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
       switch_::Switch *sw_infra2{nullptr};
       void set_sw_infra2(switch_::Switch *sw) { sw_infra2 = sw; }
       // auto-learn btn
-      esphome::button::Button *btn_learn;
+      esphome::button::Button *btn_learn{nullptr};
       void set_btn_learn(esphome::button::Button *btn) { btn_learn = btn; }
       // get params od btn
-      esphome::button::Button *btn_params_od;
+      esphome::button::Button *btn_params_od{nullptr};
       void set_btn_params_od(esphome::button::Button *btn) { btn_params_od = btn; }
       // remote learn btn
-      esphome::button::Button *btn_remote_learn;
+      esphome::button::Button *btn_remote_learn{nullptr};
       void set_btn_remote_learn(esphome::button::Button *btn) { btn_remote_learn = btn; }
+      // travel statistics
+      sensor::Sensor *open_time_sensor{nullptr};
+      void set_open_time_sensor(sensor::Sensor *s) { open_time_sensor = s; }
+      sensor::Sensor *close_time_sensor{nullptr};
+      void set_close_time_sensor(sensor::Sensor *s) { close_time_sensor = s; }
+      sensor::Sensor *cycles_sensor{nullptr};
+      void set_cycles_sensor(sensor::Sensor *s) { cycles_sensor = s; }
+      sensor::Sensor *stops_sensor{nullptr};
+      void set_stops_sensor(sensor::Sensor *s) { stops_sensor = s; }
+      sensor::Sensor *auto_closes_sensor{nullptr};
+      void set_auto_closes_sensor(sensor::Sensor *s) { auto_closes_sensor = s; }
+      // obstruction / stall
+      binary_sensor::BinarySensor *obstruction_sensor{nullptr};
+      void set_obstruction_sensor(binary_sensor::BinarySensor *s) { obstruction_sensor = s; }
+      // raw ACK RS fields
+      void set_status_sensor(uint8_t idx, sensor::Sensor *s) { if (idx < GATEPRO_STATUS_FIELDS) status_sensors_[idx] = s; }
+      text_sensor::TextSensor *txt_status_raw{nullptr};
+      void set_txt_status_raw(text_sensor::TextSensor *txt) { txt_status_raw = txt; }
       // devinfo
       text_sensor::TextSensor *txt_devinfo{nullptr};
       void set_txt_devinfo(esphome::text_sensor::TextSensor *txt) { txt_devinfo = txt; }
@@ -78,6 +256,16 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
 
       // generic re-used param setter
       void set_param(int idx, int val);
+      // param changes within this window are written in one go
+      void set_param_debounce(uint32_t ms) { param_debounce_ = ms; }
+      // min time between two state saves to flash
+      void set_save_interval(uint32_t ms) { save_interval_ = ms; }
+      // cover state publish policy
+      void set_publish_min_delta(float delta) { publish_min_delta_ = delta; }
+      void set_publish_min_interval(uint32_t ms) { publish_min_interval_ = ms; }
+      void set_publish_max_silence(uint32_t ms) { publish_max_silence_ = ms; }
+      // position requests closer than this to the current position are ignored
+      void set_min_position_change(float change) { min_pos_diff_ = change; }
       // speed control
       number::Number *speed_slider{nullptr};
       void set_speed_slider(number::Number *slider) { speed_slider = slider; }
@@ -94,6 +282,30 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
       number::Number *auto_close_slider{nullptr};
       void set_auto_close_slider(number::Number *slider) { auto_close_slider = slider; }
 
+      // max time spent dispatching received frames per loop()
+      void set_rx_budget(uint32_t ms) { rx_budget_ = ms; }
+      // min time between two transmitted frames
+      void set_tx_gap(uint32_t ms) { tx_gap_ = ms; }
+      // request/response correlation
+      void set_cmd_timeout(uint32_t ms) { cmd_timeout_ = ms; }
+      void set_max_retries(uint8_t retries) { max_retries_ = retries; }
+      void set_max_inflight(uint8_t n) { max_inflight_ = std::min<uint8_t>(n, GATEPRO_MAX_INFLIGHT); }
+      // adaptive status polling
+      void set_poll_fast_interval(uint32_t ms) { poll_fast_interval_ = ms; }
+      void set_poll_travel_interval(uint32_t ms) { poll_travel_interval_ = ms; }
+      void set_poll_idle_interval(uint32_t ms) { poll_idle_interval_ = ms; }
+      void set_poll_accel_time(uint32_t ms) { poll_accel_time_ = ms; }
+      void set_poll_decel_zone(float zone) { poll_decel_zone_ = zone; }
+      // estimate position between status samples
+      void set_interpolate(bool interpolate) { interpolate_ = interpolate; }
+      // stop ahead of partial targets based on the learned overrun
+      void set_predictive_stop(bool predictive) { predictive_stop_ = predictive; }
+      // obstruction detection and reaction
+      void set_stall_timeout(uint32_t ms) { stall_timeout_ = ms; }
+      void set_obstruction_stop(bool stop) { obstruction_stop_ = stop; }
+      void set_obstruction_retries(uint8_t retries) { obstruction_retries_ = retries; }
+      void set_obstruction_retry_delay(uint32_t ms) { obstruction_retry_delay_ = ms; }
+
       void setup() override;
       void update() override;
       void loop() override;
@@ -102,50 +314,181 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
 
    protected:
       // param logic
-      std::vector<int> params;
-      char params_cmd[50];
-      void parse_params(std::string msg);
+      std::array<uint8_t, GATEPRO_PARAMS_COUNT> params{};
+      // nothing may be read from / written based on params until the first ACK RP
+      bool params_valid_{false};
+      // params_valid_ may come from flash, writes are only built on what the controller sent since boot
+      bool params_confirmed_{false};
+      void parse_params(std::string_view fields);
       bool param_no_pub = false;
       void publish_params();
       void write_params();
-      std::queue<std::function<void()>> paramTaskQueue;
-      std::string devinfo = "N/A";
+      void flush_params();
+      void on_param_change(const GateProParamDesc &desc, int value);
+      // pending changes on top of the cached params, one dirty bit per index
+      uint8_t params_pending_[GATEPRO_PARAMS_COUNT]{};
+      uint32_t params_dirty_{0};
+      uint32_t param_debounce_{1000};
+      bool params_flush_on_read_{false};
+      char devinfo_[GATEPRO_DEVINFO_SIZE]{};
+
+      // motor event journal and the statistics derived from it
+      void record_event(GateProEvent event);
+      uint32_t travel_time(GateProEvent start, GateProEvent alt_start);
+      void publish_counters();
+      GateProJournalEntry journal_[GATEPRO_JOURNAL_SIZE]{};
+      uint8_t journal_head_{0};  // next slot to write
+      uint8_t journal_len_{0};
+      uint32_t cycles_{0};
+      uint32_t stops_{0};
+      uint32_t auto_closes_{0};
+      bool opened_since_closed_{false};
+
+      // fast boot state, persisted with write throttling
+      void restore_state();
+      void save_state();
+      ESPPreferenceObject pref_;
+      GateProSavedState saved_state_{};
+      bool state_dirty_{false};
+      uint32_t last_save_{0};
+      uint32_t save_interval_{60000};
+      // lift max_inflight until the boot queries are out
+      bool boot_burst_{false};
 
       // abstract (cover) logic
       void control(const cover::CoverCall &call) override;
       void start_direction_(cover::CoverOperation dir);
 
       // device logic
-      std::string convert(uint8_t*, size_t);
-      void process();
+      size_t escape(std::string_view in, char *out, size_t out_len);
+      void process(std::string_view frame);
+      void process_status(std::string_view fields);
+      void process_event(std::string_view body);
+      GateProEvent parse_event(std::string_view body);
+      void publish_status(const GateProStatus &status);
+      sensor::Sensor *status_sensors_[GATEPRO_STATUS_FIELDS]{};
+      GateProStatus last_status_{};
+      bool status_valid_{false};
       void queue_gatepro_cmd(GateProCmd cmd);
+      GateProTxPriority tx_priority(GateProCmd cmd);
       void read_uart();
       void write_uart();
       void debug();
-      std::queue<const char*> tx_queue;
-      std::queue<std::string> rx_queue;
+      // TX scheduler lanes
+      optional<GateProCmd> tx_motion_{};
+      std::queue<GateProTxFrame> tx_queue;
+      bool tx_poll_pending_{false};
+      uint32_t tx_gap_{100};
+      uint32_t last_tx_{0};
+      void queue_frame(const GateProTxFrame &frame);
+      void send_frame(const GateProTxFrame &frame);
+
+      // in-flight command table
+      const char* ack_prefix(GateProCmd cmd);
+      bool track_inflight(const GateProTxFrame &frame, uint8_t attempts);
+      bool is_inflight(GateProCmd cmd);
+      uint8_t inflight_count();
+      void match_ack(std::string_view frame);
+      void check_inflight();
+      GateProInflight inflight_[GATEPRO_MAX_INFLIGHT]{};
+      uint32_t inflight_seq_{0};
+      uint32_t cmd_timeout_{500};
+      uint8_t max_retries_{2};
+      uint8_t max_inflight_{2};
+      GateProLineFramer rx_framer_;
+      uint32_t rx_budget_{10};
+
+      // adaptive status polling
+      uint32_t poll_interval();
+      void schedule_poll();
+      uint32_t poll_fast_interval_{250};
+      uint32_t poll_travel_interval_{1000};
+      uint32_t poll_idle_interval_{10000};
+      uint32_t poll_accel_time_{2000};
+      float poll_decel_zone_{0.15f};
+      uint32_t last_poll_{0};
+      uint32_t motion_started_{0};
+      uint32_t poll_boost_until_{0};
+      cover::CoverOperation polled_operation_{cover::COVER_OPERATION_IDLE};
+
+      // motion estimator
+      int dir_index(cover::CoverOperation op) { return op == cover::COVER_OPERATION_CLOSING ? 1 : 0; }
+      float destination();
+      void record_sample(float pos);
+      float estimate_position();
+      bool interpolate_{true};
+      // learned travel speed per direction (opening, closing) in position/s
+      float travel_speed_[2]{0.0f, 0.0f};
+      float sample_position_{0.0f};
+      uint32_t sample_time_{0};
+      bool sample_valid_{false};
+      // weight of a new speed sample in the running average
+      const float speed_smoothing = 0.3f;
+      // samples closer than this are too noisy to learn speed from
+      const uint32_t min_sample_dt = 200;
+
+      // predictive stop
+#ifndef GATEPRO_FULL_TRAVEL
+      float stop_lead(cover::CoverOperation dir);
+#endif
+      void begin_stop_run();
+      void finish_stop_run(float pos);
+      bool predictive_stop_{true};
+      GateProStopStats stop_stats_[2];
+      GateProStopRun stop_run_;
+      int learned_decel_dist_{-1};
+      const float stop_smoothing = 0.3f;
+
+      // obstruction detection: no progress / moving backwards during travel, or a Stopped nobody asked for
+      void start_progress();
+      void track_progress(float pos);
+      void check_stall();
+      // retry: the run is resumed after obstruction_retry_delay (stall / moving backwards only)
+      void report_obstruction(const char *reason, bool retry);
+      void clear_obstruction();
+      void retry_after_obstruction();
+      uint32_t stall_timeout_{1500};
+      bool obstruction_stop_{false};
+      uint8_t obstruction_retries_{0};
+      uint32_t obstruction_retry_delay_{5000};
+      uint8_t obstruction_attempts_{0};
+      bool obstructed_{false};
+      // last sample showed no progress, poll fast until it's decided
+      bool stall_suspect_{false};
+      float progress_position_{0.0f};
+      uint32_t progress_time_{0};
+      cover::CoverOperation obstruction_dir_{cover::COVER_OPERATION_IDLE};
+      float obstruction_target_{0.0f};
 
       // sensor logic
       void correction_after_operation();
       cover::CoverOperation last_operation_{cover::COVER_OPERATION_OPENING};
       void publish();
+#ifndef GATEPRO_FULL_TRAVEL
       void stop_at_target_position();
-      // how many 'ticks' to update after position hasn't changed
-      const int after_tick_max = 10;
-      int after_tick = after_tick_max;
+      float min_pos_diff_{0.0f};
+#else
+      // smaller position changes are ignored instead of running the gate end to end
+      float min_pos_diff_{0.1f};
+#endif
+      // publish policy
+      float publish_min_delta_{0.01f};
+      uint32_t publish_min_interval_{1000};
+      uint32_t publish_max_silence_{300000};
+      uint32_t last_publish_{0};
+      cover::CoverOperation published_operation_{cover::COVER_OPERATION_IDLE};
 
       // UART parser constants
-      const std::string delimiter = "\\r\\n";
-      const uint8_t delimiter_length = delimiter.length();
-      const std::string tx_delimiter = "\r\n";
-      std::string msg_buff;
+      const std::string tx_delimiter = GATEPRO_DELIMITER;
 
       // black magic shit..
       const int known_percentage_offset = 128;
       // maximum acceptable difference in %
       const float acceptable_diff = 0.05f;
       float target_position_;
-      float position_;
+      cover::CoverOperation target_operation_{cover::COVER_OPERATION_IDLE};
+      // last published position
+      float position_{0.0f};
       bool operation_finished;
       cover::CoverCall* last_call_;
 };
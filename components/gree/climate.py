@@ -2,11 +2,19 @@
 import esphome.config_validation as cv
 import esphome.codegen as cg
 
-from esphome.components import climate, uart
+from esphome.components import climate, uart, sensor
 from esphome.const import (
     CONF_ID,
     CONF_SUPPORTED_PRESETS,
     CONF_SUPPORTED_SWING_MODES,
+    DEVICE_CLASS_FREQUENCY,
+    DEVICE_CLASS_TEMPERATURE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_CELSIUS,
+    UNIT_HERTZ,
+    UNIT_MILLISECOND,
 )
 from esphome.components.climate import (
     ClimatePreset,
@@ -15,6 +23,25 @@ from esphome.components.climate import (
 
 CODEOWNERS = ["@bekmansurov"]
 DEPENDENCIES = ["climate", "uart"]
+AUTO_LOAD = ["sensor"]
+
+CONF_PUBLISH_HEARTBEAT = "publish_heartbeat"
+CONF_SUPPRESSED_PUBLISHES = "suppressed_publishes"
+CONF_RESYNC_BYTES = "resync_bytes"
+CONF_BAD_CHECKSUMS = "bad_checksums"
+CONF_CONTROL_WINDOW = "control_window"
+CONF_MERGED_CALLS = "merged_calls"
+CONF_CONFIRM_TIMEOUT = "confirm_timeout"
+CONF_RETRY_INTERVAL = "retry_interval"
+CONF_CONFIRM_LATENCY = "confirm_latency"
+CONF_CONFIRM_FAILURES = "confirm_failures"
+CONF_OUTDOOR_TEMPERATURE = "outdoor_temperature"
+CONF_COMPRESSOR_FREQUENCY = "compressor_frequency"
+CONF_ERROR_CODE = "error_code"
+CONF_PACKET_TYPE = "packet_type"
+CONF_BYTE = "byte"
+CONF_VALUE_OFFSET = "value_offset"
+CONF_UNKNOWN_PACKETS = "unknown_packets"
 
 gree_ns = cg.esphome_ns.namespace("gree")
 GreeClimate = gree_ns.class_(
@@ -36,12 +63,91 @@ ALLOWED_CLIMATE_PRESETS = {
 }
 validate_presets = cv.enum(ALLOWED_CLIMATE_PRESETS, upper=True)
 
+
+# a byte of some packet type as a sensor: (raw - value_offset)
+# the positions differ between units, find them in the verbose frame dumps / unknown packet types log
+def packet_field_schema(value_offset, **kwargs):
+    return sensor.sensor_schema(**kwargs).extend(
+        {
+            cv.Required(CONF_PACKET_TYPE): cv.hex_uint8_t,
+            cv.Required(CONF_BYTE): cv.int_range(min=4, max=50),
+            cv.Optional(CONF_VALUE_OFFSET, default=value_offset): cv.int_range(min=-255, max=255),
+        }
+    )
+
+PACKET_FIELDS = [CONF_OUTDOOR_TEMPERATURE, CONF_COMPRESSOR_FREQUENCY, CONF_ERROR_CODE]
+
 CONFIG_SCHEMA = cv.All(
     climate.CLIMATE_SCHEMA.extend(
         {
             cv.GenerateID(): cv.declare_id(GreeClimate),
             cv.Optional(CONF_SUPPORTED_PRESETS): cv.ensure_list(validate_presets),
             cv.Optional(CONF_SUPPORTED_SWING_MODES): cv.ensure_list(validate_swing_modes),
+            # unchanged reports are only published this often, 0s never
+            cv.Optional(CONF_PUBLISH_HEARTBEAT, default="60s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_SUPPRESSED_PUBLISHES): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # RX line quality: bytes skipped to find the next frame, frames dropped for their checksum
+            cv.Optional(CONF_RESYNC_BYTES): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_BAD_CHECKSUMS): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # calls within this window go out as one frame, 0ms sends each right away
+            cv.Optional(CONF_CONTROL_WINDOW, default="150ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_MERGED_CALLS): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # commands the reports don't reflect are resent, backing off from retry_interval, until confirm_timeout
+            cv.Optional(CONF_CONFIRM_TIMEOUT, default="10s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_RETRY_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_CONFIRM_LATENCY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_CONFIRM_FAILURES): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # other packet types (offset 40 like the indoor temperature of the 0x31 report)
+            cv.Optional(CONF_OUTDOOR_TEMPERATURE): packet_field_schema(
+                40,
+                unit_of_measurement=UNIT_CELSIUS,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_TEMPERATURE,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_COMPRESSOR_FREQUENCY): packet_field_schema(
+                0,
+                unit_of_measurement=UNIT_HERTZ,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_FREQUENCY,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_ERROR_CODE): packet_field_schema(
+                0,
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            # frames of types nothing decodes (the per type histogram is logged)
+            cv.Optional(CONF_UNKNOWN_PACKETS): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
         }
     )
     # wifi module polls every 300ms but do we need it so often? set it to 10s
@@ -58,3 +164,33 @@ async def to_code(config):
         cg.add(var.set_supported_swing_modes(config[CONF_SUPPORTED_SWING_MODES]))
     if CONF_SUPPORTED_PRESETS in config:
         cg.add(var.set_supported_presets(config[CONF_SUPPORTED_PRESETS]))
+    cg.add(var.set_publish_heartbeat(config[CONF_PUBLISH_HEARTBEAT]))
+    cg.add(var.set_control_window(config[CONF_CONTROL_WINDOW]))
+    cg.add(var.set_confirm_timeout(config[CONF_CONFIRM_TIMEOUT]))
+    cg.add(var.set_retry_interval(config[CONF_RETRY_INTERVAL]))
+    if CONF_SUPPRESSED_PUBLISHES in config:
+        sens = await sensor.new_sensor(config[CONF_SUPPRESSED_PUBLISHES])
+        cg.add(var.set_suppressed_sensor(sens))
+    if CONF_RESYNC_BYTES in config:
+        sens = await sensor.new_sensor(config[CONF_RESYNC_BYTES])
+        cg.add(var.set_resync_sensor(sens))
+    if CONF_BAD_CHECKSUMS in config:
+        sens = await sensor.new_sensor(config[CONF_BAD_CHECKSUMS])
+        cg.add(var.set_bad_checksum_sensor(sens))
+    if CONF_MERGED_CALLS in config:
+        sens = await sensor.new_sensor(config[CONF_MERGED_CALLS])
+        cg.add(var.set_merged_sensor(sens))
+    if CONF_CONFIRM_LATENCY in config:
+        sens = await sensor.new_sensor(config[CONF_CONFIRM_LATENCY])
+        cg.add(var.set_confirm_latency_sensor(sens))
+    if CONF_CONFIRM_FAILURES in config:
+        sens = await sensor.new_sensor(config[CONF_CONFIRM_FAILURES])
+        cg.add(var.set_confirm_failures_sensor(sens))
+    for key in PACKET_FIELDS:
+        if key in config:
+            conf = config[key]
+            sens = await sensor.new_sensor(conf)
+            cg.add(var.add_field_sensor(sens, conf[CONF_PACKET_TYPE], conf[CONF_BYTE], conf[CONF_VALUE_OFFSET]))
+    if CONF_UNKNOWN_PACKETS in config:
+        sens = await sensor.new_sensor(config[CONF_UNKNOWN_PACKETS])
+        cg.add(var.set_unknown_packets_sensor(sens))
@@ -1,28 +1,23 @@
+#include <algorithm>
 #include <cmath>
 #include "gree.h"
 #include "esphome/core/macros.h"
+#include "esphome/core/hal.h"
+#ifdef USE_LOGGER
+#include "esphome/components/logger/logger.h"
+#endif
 
 namespace esphome {
 namespace gree {
 
 static const char *const TAG = "gree";
 
-// block of byte positions in requests/answers
-// GrKoR: I recommend change this approach (byte positions) to structures like gree_raw_packet_t.
-// You can use pointers (and type casting) for assignment structure to the data buffer.
-// It will be much much easier to work with structures instead of array and byte positions
-static const uint8_t FORCE_UPDATE = 7;
-static const uint8_t MODE = 8;
-static const uint8_t MODE_MASK = 0b11110000;
-static const uint8_t FAN_MASK = 0b00001111;
-static const uint8_t SWING = 12;
+// frame layouts: gree_report_frame_t (0x31) and gree_set_frame_t (0x01) in gree.h
+static const uint8_t FORCE_UPDATE_ON = 175;
+static const uint8_t DISPLAY_CURRENT_TEMPERATURE = 0x20;
+static const uint8_t INDOOR_TEMPERATURE_OFFSET = 40;
 
-static const uint8_t CRC_WRITE = 46;
-//CRC_READ moved to read_state_ with last bytes because of different length of incoming packets
-//static const uint8_t CRC_READ = 49;
-
-static const uint8_t TEMPERATURE = 9;
-static const uint8_t INDOOR_TEMPERATURE = 46;
+static const char *const HEX_DIGITS = "0123456789ABCDEF";
 
 // component settings
 static const uint8_t MIN_VALID_TEMPERATURE = 16;
@@ -33,42 +28,105 @@ static const uint8_t TEMPERATURE_STEP = 1;
 void GreeClimate::dump_config() {
   ESP_LOGCONFIG(TAG, "Gree:");
   ESP_LOGCONFIG(TAG, "  Update interval: %u", this->get_update_interval());
+  ESP_LOGCONFIG(TAG, "  Publish heartbeat: %u ms", this->publish_heartbeat_);
+  LOG_SENSOR("  ", "Suppressed publishes", this->suppressed_sensor_);
+  LOG_SENSOR("  ", "Resync bytes", this->resync_sensor_);
+  LOG_SENSOR("  ", "Bad checksums", this->bad_checksum_sensor_);
+  ESP_LOGCONFIG(TAG, "  Control window: %u ms", this->control_window_);
+  LOG_SENSOR("  ", "Merged calls", this->merged_sensor_);
+  ESP_LOGCONFIG(TAG, "  Confirm timeout: %u ms", this->confirm_timeout_);
+  ESP_LOGCONFIG(TAG, "  Retry interval: %u ms", this->retry_interval_);
+  LOG_SENSOR("  ", "Confirm latency", this->confirm_latency_sensor_);
+  LOG_SENSOR("  ", "Confirm failures", this->confirm_failures_sensor_);
+  for (auto &field : this->fields_) {
+    ESP_LOGCONFIG(TAG, "  Field: packet 0x%02X, byte %u, offset %d", field.type, field.index, field.offset);
+    LOG_SENSOR("    ", "Sensor", field.sensor);
+  }
+  LOG_SENSOR("  ", "Unknown packets", this->unknown_packets_sensor_);
   this->dump_traits_(TAG);
   this->check_uart_settings(4800, 1, uart::UART_CONFIG_PARITY_EVEN, 8);
 }
 
 void GreeClimate::loop() {
-  gree_raw_packet_t *raw_packet = (gree_raw_packet_t *)this->data_read_;
+  // bulk read whatever arrived, then handle every complete frame in it
+  size_t len = std::min<size_t>(this->available(), this->rx_.space());
+  if (len > 0 && this->read_array(this->rx_.tail(), len)) {
+    this->rx_.commit(len);
+  }
+
+  const uint8_t *frame;
+  uint8_t size;
+  while (this->rx_.next(frame, size)) {
+    dump_message_("Read array", frame, size, false);
+    read_frame_(frame, size);
+  }
+
+  this->check_intent_();
+}
+
+size_t GreeFrameParser::space() {
+  if (this->head_) {
+    size_t len = this->tail_ - this->head_;
+    if (len) {
+      memmove(this->buf_, this->buf_ + this->head_, len);
+    }
+    this->head_ = 0;
+    this->tail_ = len;
+  }
+  return GREE_RX_STREAM_SIZE - this->tail_;
+}
 
-  while (!receiving_packet_ && this->available() >= sizeof(gree_header_t)) {
-    if (this->peek() != GREE_START_BYTE) {
-      this->read(); // read byte to nowhere
+bool GreeFrameParser::next(const uint8_t *&frame, uint8_t &size) {
+  while (this->tail_ - this->head_ >= sizeof(gree_header_t)) {
+    const uint8_t *start = this->buf_ + this->head_;
+    const size_t avail = this->tail_ - this->head_;
+
+    // resync to the next 0x7E 0x7E (memchr compares a word at a time)
+    if (start[0] != GREE_START_BYTE || start[1] != GREE_START_BYTE) {
+      auto *found = (const uint8_t *) memchr(start + 1, GREE_START_BYTE, avail - 1);
+      this->skip_(found != nullptr ? found - start : avail);
       continue;
     }
 
-    this->read_array(this->data_read_, sizeof(gree_start_bytes_t));
-    receiving_packet_ = (raw_packet->header.start_bytes.u8x2[1] == GREE_START_BYTE);
-    
-    if (receiving_packet_) {
-      this->read_byte( &raw_packet->header.data_length );
-
-      if (raw_packet->header.data_length + sizeof(gree_header_t) > GREE_RX_BUFFER_SIZE) {
-        ESP_LOGE(TAG, "Incoming packet is too big! header.data_length = %d, maximum is %d", raw_packet->header.data_length, GREE_RX_BUFFER_SIZE - sizeof(gree_header_t));
-        receiving_packet_ = false;
-        memset(this->data_read_, 0, GREE_RX_BUFFER_SIZE);
-      }
+    // at least the packet type and the checksum
+    const uint8_t data_length = start[2];
+    const size_t total = data_length + sizeof(gree_header_t);
+    if (data_length < 2 || total > GREE_RX_BUFFER_SIZE) {
+      ESP_LOGD(TAG, "Invalid packet length %u, resyncing", data_length);
+      this->skip_(1);
+      continue;
     }
-  }
 
-  if (receiving_packet_ && this->available() >= raw_packet->header.data_length) {
-    this->read_array(raw_packet->data, raw_packet->header.data_length);
+    // checksum covers everything after the start bytes but itself, summed as the bytes come in
+    for (const size_t end = std::min(avail, total - 1); this->summed_ < end; this->summed_++) {
+      this->sum_ += start[this->summed_];
+    }
+    if (avail < total) {
+      return false;
+    }
+    if (this->sum_ != start[total - 1]) {
+      ESP_LOGD(TAG, "Invalid checksum.");
+      this->bad_checksums_++;
+      this->skip_(1);
+      continue;
+    }
 
-    dump_message_("Read array", this->data_read_, raw_packet->header.data_length + sizeof(gree_header_t));
-    read_state_(this->data_read_, raw_packet->header.data_length + sizeof(gree_header_t));
-    
-    receiving_packet_ = false;
-    memset(this->data_read_, 0, GREE_RX_BUFFER_SIZE);
+    frame = start;
+    size = total;
+    this->head_ += total;
+    this->summed_ = sizeof(gree_start_bytes_t);
+    this->sum_ = 0;
+    return true;
   }
+  return false;
+}
+
+// drop bytes that can't start a frame
+void GreeFrameParser::skip_(size_t len) {
+  this->head_ += len;
+  this->resync_bytes_ += len;
+  this->summed_ = sizeof(gree_start_bytes_t);
+  this->sum_ = 0;
 }
 
 /*
@@ -78,8 +136,21 @@ void GreeClimate::setup() {
 */
 
 void GreeClimate::update() {
-  data_write_[CRC_WRITE] = get_checksum_(data_write_, sizeof(data_write_));
-  send_data_(data_write_, sizeof(data_write_));
+  this->send_frame_();
+
+  // reported from here rather than per frame, so the diagnostics don't add to the noise they count
+  this->publish_counter_(this->suppressed_sensor_, this->suppressed_publishes_);
+  this->publish_counter_(this->resync_sensor_, this->rx_.resync_bytes());
+  this->publish_counter_(this->bad_checksum_sensor_, this->rx_.bad_checksums());
+  this->publish_counter_(this->merged_sensor_, this->merged_calls_);
+  this->publish_counter_(this->confirm_failures_sensor_, this->confirm_failures_);
+  this->publish_counter_(this->unknown_packets_sensor_, this->unknown_packets_);
+  this->log_unknown_types_();
+}
+
+void GreeClimate::publish_counter_(sensor::Sensor *sensor, uint32_t value) {
+  if (sensor != nullptr && (!sensor->has_state() || sensor->state != value))
+    sensor->publish_state(value);
 }
 
 climate::ClimateTraits GreeClimate::traits() {
@@ -118,33 +189,122 @@ climate::ClimateTraits GreeClimate::traits() {
   return traits;
 }
 
-void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
-  // get checksum byte from received data (using the last byte in packet)
-  uint8_t data_crc = data[size-1];
-  // get checksum byte based on received data (calculating)
-  uint8_t get_crc = get_checksum_(data, size);
+// frames come from GreeFrameParser, with the checksum verified already
+void GreeClimate::read_frame_(const uint8_t *data, uint8_t size) {
+  // per packet type decoders, on top of the configured field sensors
+  static const struct {
+    uint8_t type;
+    void (GreeClimate::*read)(const uint8_t *, uint8_t);
+  } READERS[] = {
+    {GREE_PACKET_REPORT, &GreeClimate::read_state_},
+  };
+
+  const uint8_t type = data[offsetof(gree_report_frame_t, type)];
+  bool known = this->read_fields_(data, size);
+  for (const auto &reader : READERS) {
+    if (reader.type == type) {
+      (this->*reader.read)(data, size);
+      known = true;
+      break;
+    }
+  }
+  if (!known)
+    this->count_unknown_(type);
+}
+
+// configured bytes of any packet type, published on change
+bool GreeClimate::read_fields_(const uint8_t *data, uint8_t size) {
+  const uint8_t type = data[offsetof(gree_report_frame_t, type)];
+  bool known = false;
+  for (auto &field : this->fields_) {
+    if (field.type != type)
+      continue;
+    known = true;
+    // the last byte is the checksum
+    if (field.index >= size - 1)
+      continue;
+    const float value = data[field.index] - field.offset;
+    if (!field.sensor->has_state() || field.sensor->state != value)
+      field.sensor->publish_state(value);
+  }
+  return known;
+}
 
-  if (data_crc != get_crc) {
-    ESP_LOGW(TAG, "Invalid checksum.");
+// nothing decodes this type: count it rather than log every frame, update() logs the histogram
+void GreeClimate::count_unknown_(uint8_t type) {
+  this->unknown_packets_++;
+  for (uint8_t i = 0; i < this->unknown_type_slots_; i++) {
+    if (this->unknown_types_[i].type == type) {
+      this->unknown_types_[i].count++;
+      return;
+    }
+  }
+  if (this->unknown_type_slots_ < GREE_UNKNOWN_TYPE_SLOTS) {
+    ESP_LOGD(TAG, "Unknown packet type 0x%02X", type);
+    this->unknown_types_[this->unknown_type_slots_++] = {type, 1};
     return;
   }
+  this->unknown_other_++;
+}
 
-// now we are using only packets with 0x31 as first data byte (byte 3 in packet)
-  if (data[3] != 49) {
-    ESP_LOGW(TAG, "Invalid packet type (%s)", data[3]);
+void GreeClimate::log_unknown_types_() {
+  if (this->unknown_packets_ == this->unknown_logged_)
     return;
+  this->unknown_logged_ = this->unknown_packets_;
+
+  // "0xXX:<count> " per type
+  char str[GREE_UNKNOWN_TYPE_SLOTS * 16 + 24];
+  char *pstr = str;
+  const char *end = str + sizeof(str);
+  for (uint8_t i = 0; i < this->unknown_type_slots_; i++) {
+    pstr += snprintf(pstr, end - pstr, "0x%02X:%u ", this->unknown_types_[i].type, this->unknown_types_[i].count);
   }
+  if (this->unknown_other_)
+    pstr += snprintf(pstr, end - pstr, "other:%u ", this->unknown_other_);
+  *(pstr > str ? pstr - 1 : pstr) = '\0';
+  ESP_LOGD(TAG, "Unknown packet types: %s", str);
+}
 
-  this->target_temperature = data[TEMPERATURE] / 16 + MIN_VALID_TEMPERATURE;
-  this->current_temperature = data[INDOOR_TEMPERATURE] - 40; // check later?
+void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
+  const auto *report = reinterpret_cast<const gree_report_frame_t *>(data);
+  if (size < sizeof(gree_report_frame_t) + 1) {
+    ESP_LOGW(TAG, "Report too short (%u bytes)", size);
+    return;
+  }
+  const gree_state_t &state = report->state;
+  const uint32_t now = millis();
+
+  if (this->intent_.fields && this->intent_confirmed_(state)) {
+    const uint32_t latency = now - this->intent_.sent_at;
+    ESP_LOGD(TAG, "Command confirmed after %u ms (%u attempts)", latency, this->intent_.attempts);
+    if (this->confirm_latency_sensor_ != nullptr)
+      this->confirm_latency_sensor_->publish_state(latency);
+    this->intent_.fields = 0;
+  }
+
+  // partially saving current state to previous request, unless that would undo calls not sent or confirmed yet
+  if (this->pending_calls_ == 0 && this->intent_.fields == 0) {
+    data_write_.state.mode_fan = state.mode_fan;
+    // add target temperature state too? ok
+    data_write_.state.temperature = state.temperature;
+  }
+
+  // the unit reports several times a second, only publish real changes (and a heartbeat)
+  const gree_snapshot_t snapshot{state.mode_fan, state.temperature, state.preset, state.swing, report->indoor_temperature};
+  if (this->published_valid_ && memcmp(&snapshot, &this->published_, sizeof(snapshot)) == 0 &&
+      (!this->publish_heartbeat_ || now - this->last_publish_ < this->publish_heartbeat_)) {
+    this->suppressed_publishes_++;
+    return;
+  }
+  this->published_ = snapshot;
+  this->published_valid_ = true;
+  this->last_publish_ = now;
 
-  // partially saving current state to previous request
-  data_write_[MODE] = data[MODE];
-  // add target temperature state too? ok
-  data_write_[TEMPERATURE] = data[TEMPERATURE];
+  this->target_temperature = state.temperature / 16 + MIN_VALID_TEMPERATURE;
+  this->current_temperature = report->indoor_temperature - INDOOR_TEMPERATURE_OFFSET; // check later?
 
   // update CLIMATE state according AC response
-  switch (data[MODE] & MODE_MASK) {
+  switch (state.mode()) {
     case AC_MODE_OFF:
       this->mode = climate::CLIMATE_MODE_OFF;
       break;
@@ -164,11 +324,11 @@ void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
       this->mode = climate::CLIMATE_MODE_HEAT;
       break;
     default:
-      ESP_LOGW(TAG, "Unknown AC MODE&fan: %s", data[MODE]);
+      ESP_LOGW(TAG, "Unknown AC MODE&fan: 0x%02X", state.mode_fan);
   }
 
   // get current AC FAN SPEED from its response
-  switch (data[MODE] & FAN_MASK) {
+  switch (state.fan()) {
     case AC_FAN_AUTO:
       this->fan_mode = climate::CLIMATE_FAN_AUTO;
       break;
@@ -182,11 +342,11 @@ void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
       this->fan_mode = climate::CLIMATE_FAN_HIGH;
       break;
     default:
-      ESP_LOGW(TAG, "Unknown AC mode&FAN: %s", data[MODE]);
+      ESP_LOGW(TAG, "Unknown AC mode&FAN: 0x%02X", state.mode_fan);
   }
 
   
-  switch (data[SWING]) {
+  switch (state.swing) {
     case AC_SWING_OFF:
       this->swing_mode = climate::CLIMATE_SWING_OFF;
       break;
@@ -205,7 +365,7 @@ void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
   }
   
 
-  switch (data[10]) {
+  switch (state.preset) {
     case 7:
       // when COOL TURBO
       this->preset = climate::CLIMATE_PRESET_BOOST;
@@ -223,10 +383,6 @@ void GreeClimate::read_state_(const uint8_t *data, uint8_t size) {
 }
 
 void GreeClimate::control(const climate::ClimateCall &call) {
-  data_write_[FORCE_UPDATE] = 175;
-  // show current temperature on display every time when sending new command. TEST!
-  data_write_[13] = 0x20;
-  
 /*
   // logging of saved mode&fan vars
   char str[250] = {0};
@@ -238,9 +394,12 @@ void GreeClimate::control(const climate::ClimateCall &call) {
 */
 
   // saving mode&fan values from previous 
-  uint8_t new_mode = data_write_[MODE] & MODE_MASK;
-  uint8_t new_fan_speed = data_write_[MODE] & FAN_MASK;
+  uint8_t new_mode = data_write_.state.mode();
+  uint8_t new_fan_speed = data_write_.state.fan();
 
+  // only what the call actually sets has to show up in the reports
+  if (call.get_mode().has_value() || call.get_fan_mode().has_value())
+    this->pending_fields_ |= GREE_INTENT_MODE_FAN;
   if (call.get_mode().has_value()) {
     switch (call.get_mode().value()) {
       case climate::CLIMATE_MODE_OFF:
@@ -263,7 +422,7 @@ void GreeClimate::control(const climate::ClimateCall &call) {
         new_mode = AC_MODE_HEAT;
         break;
       default:
-        ESP_LOGW(TAG, "Setting of unsupported MODE: %s", call.get_mode().value());
+        ESP_LOGW(TAG, "Setting of unsupported MODE: %d", (int) call.get_mode().value());
         break;
     }
   }
@@ -284,7 +443,7 @@ void GreeClimate::control(const climate::ClimateCall &call) {
         new_fan_speed = AC_FAN_HIGH;
         break;
       default:
-        ESP_LOGW(TAG, "Setting of unsupported FANSPEED: %s", call.get_fan_mode().value());
+        ESP_LOGW(TAG, "Setting of unsupported FANSPEED: %d", (int) call.get_fan_mode().value());
         break;
     }
   }
@@ -299,16 +458,16 @@ void GreeClimate::control(const climate::ClimateCall &call) {
     switch (call.get_preset().value()) {
       case climate::CLIMATE_PRESET_NONE:
         if (new_mode == AC_MODE_COOL) {
-          data_write_[10] = 6;
+          data_write_.state.preset = 6;
         } else if (new_mode == AC_MODE_HEAT) {
-          data_write_[10] = 14;
+          data_write_.state.preset = 14;
         }
         break;
       case climate::CLIMATE_PRESET_BOOST:
         if (new_mode == AC_MODE_COOL) {
-          data_write_[10] = 7;
+          data_write_.state.preset = 7;
         } else if (new_mode == AC_MODE_HEAT) {
-          data_write_[10] = 15;
+          data_write_.state.preset = 15;
         }
         // skip preset when not COOL or HEAT mode
         break;
@@ -332,52 +491,161 @@ void GreeClimate::control(const climate::ClimateCall &call) {
 
   if (call.get_target_temperature().has_value()) {
     // check if temperature set in valid limits
-    if (call.get_target_temperature().value() >= MIN_VALID_TEMPERATURE && call.get_target_temperature().value() <= MAX_VALID_TEMPERATURE)
-      data_write_[TEMPERATURE] = (call.get_target_temperature().value() - MIN_VALID_TEMPERATURE) * 16;
+    if (call.get_target_temperature().value() >= MIN_VALID_TEMPERATURE && call.get_target_temperature().value() <= MAX_VALID_TEMPERATURE) {
+      data_write_.state.temperature = (call.get_target_temperature().value() - MIN_VALID_TEMPERATURE) * 16;
+      this->pending_fields_ |= GREE_INTENT_TEMPERATURE;
+    }
   }
 
   // temporary disabled
   if (call.get_swing_mode().has_value()) {
+    this->pending_fields_ |= GREE_INTENT_SWING;
     switch (call.get_swing_mode().value()) {
       case climate::CLIMATE_SWING_OFF:
-        data_write_[SWING] = AC_SWING_OFF;
+        data_write_.state.swing = AC_SWING_OFF;
         break;
       case climate::CLIMATE_SWING_VERTICAL:
-        data_write_[SWING] = AC_SWING_VERTICAL;
+        data_write_.state.swing = AC_SWING_VERTICAL;
         break;
       case climate::CLIMATE_SWING_HORIZONTAL:
-        data_write_[SWING] = AC_SWING_HORIZONTAL;
+        data_write_.state.swing = AC_SWING_HORIZONTAL;
         break;
       case climate::CLIMATE_SWING_BOTH:
-        data_write_[SWING] = AC_SWING_BOTH;
+        data_write_.state.swing = AC_SWING_BOTH;
         break;
     }
   }
 
-  data_write_[MODE] = new_mode + new_fan_speed;
+  data_write_.state.set_mode_fan(new_mode, new_fan_speed);
+
+  // calls within the window (e.g. a scene setting mode, temperature, fan and swing one by one)
+  // are applied on top of each other and sent as a single frame
+  if (this->control_window_ == 0) {
+    this->pending_calls_ = 1;
+    this->flush_control_();
+    return;
+  }
+  if (this->pending_calls_++ == 0) {
+    this->set_timeout("control", this->control_window_, [this]() { this->flush_control_(); });
+  }
+}
+
+void GreeClimate::flush_control_() {
+  if (this->pending_calls_ == 0)
+    return;
+  if (this->pending_calls_ > 1) {
+    ESP_LOGD(TAG, "Merged %u calls into one frame", this->pending_calls_);
+    this->merged_calls_ += this->pending_calls_ - 1;
+  }
+  this->pending_calls_ = 0;
+
+  this->send_command_();
+
+  // wait for the reports to confirm it (on top of a command still unconfirmed, data_write_ holds both)
+  this->intent_.fields |= this->pending_fields_;
+  this->pending_fields_ = 0;
+  if (this->intent_.fields) {
+    const uint32_t now = millis();
+    this->intent_.attempts = 1;
+    this->intent_.sent_at = now;
+    this->intent_.retry_at = now + this->retry_interval_;
+  }
+}
+
+void GreeClimate::send_command_() {
+  data_write_.force_update = FORCE_UPDATE_ON;
+  // show current temperature on display every time when sending new command. TEST!
+  data_write_.display = DISPLAY_CURRENT_TEMPERATURE;
 
-  // compute checksum & send data
-  data_write_[CRC_WRITE] = get_checksum_(data_write_, sizeof(data_write_));
-  send_data_(data_write_, sizeof(data_write_));
+  this->send_frame_();
 
   // change of force_update byte to "passive" state
-  data_write_[FORCE_UPDATE] = 0;
+  data_write_.force_update = 0;
+}
+
+// does the report show everything the pending command set?
+bool GreeClimate::intent_confirmed_(const gree_state_t &reported) {
+  const gree_state_t &wanted = this->data_write_.state;
+  if (this->intent_.fields & GREE_INTENT_MODE_FAN) {
+    if (reported.mode() != wanted.mode())
+      return false;
+    // the fan isn't meaningful while off
+    if (wanted.mode() != AC_MODE_OFF && reported.fan() != wanted.fan())
+      return false;
+  }
+  // whole degrees only, as published
+  if ((this->intent_.fields & GREE_INTENT_TEMPERATURE) && reported.temperature / 16 != wanted.temperature / 16)
+    return false;
+  if ((this->intent_.fields & GREE_INTENT_SWING) && reported.swing != wanted.swing)
+    return false;
+  return true;
+}
+
+// resend an unconfirmed command with backoff, give up (and follow the reports again) after confirm_timeout
+void GreeClimate::check_intent_() {
+  if (this->intent_.fields == 0 || this->pending_calls_ != 0)
+    return;
+  const uint32_t now = millis();
+  if (now - this->intent_.sent_at >= this->confirm_timeout_) {
+    ESP_LOGW(TAG, "Command not confirmed after %u attempts, giving up", this->intent_.attempts);
+    this->confirm_failures_++;
+    this->intent_.fields = 0;
+    return;
+  }
+  if ((int32_t) (now - this->intent_.retry_at) < 0)
+    return;
+
+  ESP_LOGD(TAG, "Command not confirmed yet, resending (attempt %u)", this->intent_.attempts + 1);
+  this->send_command_();
+  // 1x, 2x, 4x... the retry interval
+  this->intent_.retry_at = now + (this->retry_interval_ << std::min<uint8_t>(this->intent_.attempts, 4));
+  this->intent_.attempts++;
+}
+
+// compute checksum & send the TX frame as is
+void GreeClimate::send_frame_() {
+  const auto *frame = reinterpret_cast<uint8_t *>(&this->data_write_);
+  this->data_write_.crc = get_checksum_(frame, sizeof(this->data_write_));
+  send_data_(frame, sizeof(this->data_write_));
 }
 
 void GreeClimate::send_data_(const uint8_t *message, uint8_t size) {
   this->write_array(message, size);
-  dump_message_("Sent message", message, size);
+  dump_message_("Sent message", message, size, true);
 }
 
-void GreeClimate::dump_message_(const char *title, const uint8_t *message, uint8_t size) {
-  ESP_LOGV(TAG, "%s:", title);
-  char str[250] = {0};
+void GreeClimate::dump_message_(const char *title, const uint8_t *message, uint8_t size, bool tx) {
+  this->frame_callback_.call(tx, message, size);
+
+  // formatting is only worth it if the line is actually going to be logged
+  if (!this->trace_enabled_())
+    return;
+
+  // "XX " per byte, the last space becomes the terminator
+  char str[GREE_RX_BUFFER_SIZE * 3];
+  if (size > GREE_RX_BUFFER_SIZE) {
+    ESP_LOGE(TAG, "too long byte data");
+    size = GREE_RX_BUFFER_SIZE;
+  }
   char *pstr = str;
-  if (size * 2 > sizeof(str)) ESP_LOGE(TAG, "too long byte data");
   for (int i = 0; i < size; i++) {
-    pstr += sprintf(pstr, "%02X ", message[i]);
+    *pstr++ = HEX_DIGITS[message[i] >> 4];
+    *pstr++ = HEX_DIGITS[message[i] & 0x0F];
+    *pstr++ = ' ';
   }
-  ESP_LOGV(TAG, "%s", str);
+  *(size ? pstr - 1 : pstr) = '\0';
+  ESP_LOGV(TAG, "%s: %s", title, str);
+}
+
+// verbose level for our tag, checked at run time (the logger level can be lowered per tag)
+bool GreeClimate::trace_enabled_() {
+#if ESPHOME_LOG_LEVEL < ESPHOME_LOG_LEVEL_VERBOSE
+  return false;
+#elif defined(USE_LOGGER)
+  return logger::global_logger != nullptr && logger::global_logger->level_for(TAG) >= ESPHOME_LOG_LEVEL_VERBOSE;
+#else
+  return false;
+#endif
 }
 
 uint8_t GreeClimate::get_checksum_(const uint8_t *message, size_t size) {
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
 #include "esphome/core/component.h"
 #include "esphome/components/climate/climate.h"
 #include "esphome/components/uart/uart.h"
+#include "esphome/components/sensor/sensor.h"
 #include "esphome/core/log.h"
 
 namespace esphome {
@@ -57,6 +60,10 @@ enum ac_louver_H: uint8_t {
 
 #define GREE_START_BYTE 0x7E
 #define GREE_RX_BUFFER_SIZE 52
+// room for a frame being received plus the next ones already in the UART buffer
+#define GREE_RX_STREAM_SIZE 128
+// distinct unknown packet types counted one by one, the rest share one bucket
+#define GREE_UNKNOWN_TYPE_SLOTS 8
 
 union gree_start_bytes_t {
 //     uint16_t u16;
@@ -75,7 +82,131 @@ struct gree_raw_packet_t
   uint8_t data[1]; // first data byte
 };
 
+// first data byte (byte 3 in packet)
+enum gree_packet_type: uint8_t {
+  GREE_PACKET_SET = 0x01,
+  GREE_PACKET_REPORT = 0x31
+};
+
+// mode / fan / temperature / swing block, same layout in both directions (bytes 8-12)
+struct gree_state_t
+{
+  uint8_t mode_fan;     // ac_mode in the high nibble, ac_fan in the low one
+  uint8_t temperature;  // (target - MIN_VALID_TEMPERATURE) * 16
+  uint8_t preset;       // 6 / 7 COOL (TURBO), 14 / 15 HEAT (TURBO)
+  uint8_t unknown;
+  uint8_t swing;        // ac_swing
+
+  uint8_t mode() const { return this->mode_fan & 0xF0; }
+  uint8_t fan() const { return this->mode_fan & 0x0F; }
+  void set_mode_fan(uint8_t mode, uint8_t fan) { this->mode_fan = (mode & 0xF0) | (fan & 0x0F); }
+} __attribute__((packed));
+
+// 0x31: state report from the unit, read in place from the RX buffer
+// (longer reports carry extra bytes after indoor_temperature, the checksum is always the last byte)
+struct gree_report_frame_t
+{
+  gree_header_t header;
+  uint8_t type;                // GREE_PACKET_REPORT
+  uint8_t unknown4[4];
+  gree_state_t state;
+  uint8_t unknown13[33];
+  uint8_t indoor_temperature;  // +40
+} __attribute__((packed));
+
+// 0x01: set command, kept as the reusable TX frame
+// Parts of the message that must have specific values for "send" command.
+// These are not 0x00 and the meaning of those values is unknown at the moment.
+// unknown14[27] (byte 41) = 12; // unknown but not 0x00. TODO
+struct gree_set_frame_t
+{
+  gree_header_t header{{{GREE_START_BYTE, GREE_START_BYTE}}, 0x2C};
+  uint8_t type{GREE_PACKET_SET};
+  uint8_t unknown4[3]{};
+  uint8_t force_update{0};     // 175 makes the unit apply the frame, 0 otherwise
+  gree_state_t state{0x00, 0x00, 0x02, 0x02, 0x00};
+  uint8_t display{0};          // 0x20 shows the current temperature
+  uint8_t unknown14[32]{};
+  uint8_t crc{0};
+} __attribute__((packed));
+
+// fields of a sent command that the following reports have to confirm
+enum gree_intent_field: uint8_t {
+  GREE_INTENT_MODE_FAN = 1 << 0,
+  GREE_INTENT_TEMPERATURE = 1 << 1,
+  GREE_INTENT_SWING = 1 << 2
+};
+
+// a command sent but not confirmed by a report yet (the wanted values are in data_write_)
+struct gree_intent_t
+{
+  uint8_t fields;     // gree_intent_field bits, 0 if nothing is pending
+  uint8_t attempts;   // frames sent so far
+  uint32_t sent_at;   // first send
+  uint32_t retry_at;
+};
+
+// a byte of some packet type published to a sensor as (raw - offset), e.g. outdoor temperature
+struct gree_field_t
+{
+  sensor::Sensor *sensor;
+  uint8_t type;
+  uint8_t index;
+  int16_t offset;
+};
+
+// histogram bucket of packet types nothing decodes
+struct gree_type_count_t
+{
+  uint8_t type;
+  uint32_t count;
+};
+
+// everything a report publishes, compared against the last published one
+struct gree_snapshot_t
+{
+  uint8_t mode_fan;
+  uint8_t temperature;
+  uint8_t preset;
+  uint8_t swing;
+  uint8_t indoor_temperature;
+} __attribute__((packed));
+
+static_assert(offsetof(gree_report_frame_t, state) == 8, "gree_report_frame_t: state must start at byte 8");
+static_assert(offsetof(gree_report_frame_t, indoor_temperature) == 46, "gree_report_frame_t: indoor temperature must be byte 46");
+static_assert(sizeof(gree_report_frame_t) <= GREE_RX_BUFFER_SIZE, "gree_report_frame_t must fit into a frame");
+static_assert(offsetof(gree_set_frame_t, force_update) == 7, "gree_set_frame_t: force update must be byte 7");
+static_assert(offsetof(gree_set_frame_t, state) == 8, "gree_set_frame_t: state must start at byte 8");
+static_assert(offsetof(gree_set_frame_t, display) == 13, "gree_set_frame_t: display must be byte 13");
+static_assert(sizeof(gree_set_frame_t) == 47, "gree_set_frame_t must be exactly 47 bytes");
+
+
+
+// splits the byte stream into checksum-verified frames, in place
+// (compacted rather than wrapped around, so a frame is always contiguous for the structs above)
+class GreeFrameParser {
+ public:
+  // contiguous free space at tail(), after moving the unconsumed bytes to the front
+  size_t space();
+  uint8_t *tail() { return this->buf_ + this->tail_; }
+  void commit(size_t len) { this->tail_ += len; }
+  // next valid frame, only valid until space() is called again
+  bool next(const uint8_t *&frame, uint8_t &size);
+  uint32_t resync_bytes() const { return this->resync_bytes_; }
+  uint32_t bad_checksums() const { return this->bad_checksums_; }
 
+ protected:
+  void skip_(size_t len);
+
+  uint8_t buf_[GREE_RX_STREAM_SIZE];
+  size_t head_{0};
+  size_t tail_{0};
+  // running checksum of the frame at head_, offset (from head_) of the next byte to add
+  size_t summed_{sizeof(gree_start_bytes_t)};
+  uint8_t sum_{0};
+  uint32_t resync_bytes_{0};
+  uint32_t bad_checksums_{0};
+};
 
 /*
 class Constants {
@@ -97,25 +228,88 @@ class GreeClimate : public climate::Climate, public uart::UARTDevice, public Pol
   void set_supported_swing_modes(const std::set<climate::ClimateSwingMode> &modes) {
      this->supported_swing_modes_ = modes;
   }
+  // unchanged reports are published at most this often (0: never)
+  void set_publish_heartbeat(uint32_t ms) { this->publish_heartbeat_ = ms; }
+  void set_suppressed_sensor(sensor::Sensor *sensor) { this->suppressed_sensor_ = sensor; }
+  void set_resync_sensor(sensor::Sensor *sensor) { this->resync_sensor_ = sensor; }
+  void set_bad_checksum_sensor(sensor::Sensor *sensor) { this->bad_checksum_sensor_ = sensor; }
+  // control() calls within this window are sent as one frame (0: every call right away)
+  void set_control_window(uint32_t ms) { this->control_window_ = ms; }
+  void set_merged_sensor(sensor::Sensor *sensor) { this->merged_sensor_ = sensor; }
+  // resend commands the unit's reports don't reflect, backing off from retry_interval, until confirm_timeout
+  void set_confirm_timeout(uint32_t ms) { this->confirm_timeout_ = ms; }
+  void set_retry_interval(uint32_t ms) { this->retry_interval_ = ms; }
+  void set_confirm_latency_sensor(sensor::Sensor *sensor) { this->confirm_latency_sensor_ = sensor; }
+  void set_confirm_failures_sensor(sensor::Sensor *sensor) { this->confirm_failures_sensor_ = sensor; }
+  // decode byte `index` of packet type `type` into sensor (positions are per unit, see the verbose frame dumps)
+  void add_field_sensor(sensor::Sensor *sensor, uint8_t type, uint8_t index, int16_t offset) {
+    this->fields_.push_back({sensor, type, index, offset});
+  }
+  void set_unknown_packets_sensor(sensor::Sensor *sensor) { this->unknown_packets_sensor_ = sensor; }
+  // binary capture sink: every frame as it went over the wire (tx = sent by us), for offline decoding
+  void add_on_frame_callback(std::function<void(bool tx, const uint8_t *data, size_t size)> &&callback) {
+    this->frame_callback_.add(std::move(callback));
+  }
 
  protected:
   climate::ClimateTraits traits() override;
+  void read_frame_(const uint8_t *data, uint8_t size);
   void read_state_(const uint8_t *data, uint8_t size);
+  bool read_fields_(const uint8_t *data, uint8_t size);
+  void count_unknown_(uint8_t type);
+  void log_unknown_types_();
   void send_data_(const uint8_t *message, uint8_t size);
-  void dump_message_(const char *title, const uint8_t *message, uint8_t size);
+  void send_frame_();
+  void flush_control_();
+  void send_command_();
+  bool intent_confirmed_(const gree_state_t &reported);
+  void check_intent_();
+  void dump_message_(const char *title, const uint8_t *message, uint8_t size, bool tx);
+  bool trace_enabled_();
   uint8_t get_checksum_(const uint8_t *message, size_t size);
+  void publish_counter_(sensor::Sensor *sensor, uint32_t value);
 
  private:
   // uint32_t _update_period = Constants::AC_STATE_REQUEST_INTERVAL;
 
-  // Parts of the message that must have specific values for "send" command.
-  // These are not 0x00 and the meaning of those values is unknown at the moment.
-  // Others set to 0x00
-  // data_write_[41] = 12; // unknown but not 0x00. TODO
-  uint8_t data_write_[47] = {0x7E, 0x7E, 0x2C, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-  uint8_t data_read_[GREE_RX_BUFFER_SIZE] = {0};
+  gree_set_frame_t data_write_{};
+  GreeFrameParser rx_{};
+
+  // change-only publishing
+  gree_snapshot_t published_{};
+  bool published_valid_ = false;
+  uint32_t last_publish_ = 0;
+  uint32_t publish_heartbeat_ = 60000;
+  uint32_t suppressed_publishes_ = 0;
+  sensor::Sensor *suppressed_sensor_{nullptr};
+  sensor::Sensor *resync_sensor_{nullptr};
+  sensor::Sensor *bad_checksum_sensor_{nullptr};
+
+  // control() coalescing
+  uint32_t control_window_ = 150;
+  uint8_t pending_calls_ = 0;
+  uint8_t pending_fields_ = 0;
+  uint32_t merged_calls_ = 0;
+  sensor::Sensor *merged_sensor_{nullptr};
+
+  // command confirmation
+  gree_intent_t intent_{};
+  uint32_t confirm_timeout_ = 10000;
+  uint32_t retry_interval_ = 1000;
+  uint32_t confirm_failures_ = 0;
+  sensor::Sensor *confirm_latency_sensor_{nullptr};
+  sensor::Sensor *confirm_failures_sensor_{nullptr};
+
+  // other packet types
+  std::vector<gree_field_t> fields_{};
+  gree_type_count_t unknown_types_[GREE_UNKNOWN_TYPE_SLOTS]{};
+  uint8_t unknown_type_slots_ = 0;
+  uint32_t unknown_other_ = 0;
+  uint32_t unknown_packets_ = 0;
+  uint32_t unknown_logged_ = 0;
+  sensor::Sensor *unknown_packets_sensor_{nullptr};
 
-  bool receiving_packet_ = false;
+  CallbackManager<void(bool, const uint8_t *, size_t)> frame_callback_{};
 
   std::set<climate::ClimatePreset> supported_presets_{};
   std::set<climate::ClimateSwingMode> supported_swing_modes_{};
@@ -0,0 +1,165 @@
+#include "gatepro_emulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace gatepro_host {
+
+static bool starts_with(std::string_view str, std::string_view prefix) {
+   return str.substr(0, prefix.size()) == prefix;
+}
+
+void GateProEmulator::receive(const uint8_t *data, size_t len) {
+   this->line_.append(reinterpret_cast<const char *>(data), len);
+   size_t pos;
+   while ((pos = this->line_.find("\r\n")) != std::string::npos) {
+      std::string line = this->line_.substr(0, pos);
+      this->line_.erase(0, pos + 2);
+      this->handle(line);
+   }
+}
+
+void GateProEmulator::remote(std::string_view line) {
+   this->handle(line);
+   this->commands.pop_back();
+}
+
+void GateProEmulator::handle(std::string_view line) {
+   line = line.substr(0, line.find(";src="));
+   this->commands.emplace_back(line);
+
+   char buf[96];
+   if (line == "RS") {
+      // percentage with the +128 offset the real controller sometimes reports
+      const int percentage = std::lround(this->position_ * 100) + 128;
+      snprintf(buf, sizeof(buf), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF", percentage);
+      this->reply(buf, this->profile_.reply_delay_ms);
+   } else if (line == "RP,1:") {
+      if (!this->answer_params) return;
+      int len = snprintf(buf, sizeof(buf), "ACK RP,1:");
+      for (size_t i = 0; i < sizeof(this->params); i++) {
+         len += snprintf(buf + len, sizeof(buf) - len, i ? ",%u" : "%u", this->params[i]);
+      }
+      this->reply(buf, this->profile_.reply_delay_ms);
+   } else if (starts_with(line, "WP,1:")) {
+      std::string_view fields = line.substr(5);
+      for (size_t i = 0; i < sizeof(this->params) && !fields.empty(); i++) {
+         this->params[i] = atoi(std::string(fields.substr(0, fields.find(','))).c_str());
+         const size_t comma = fields.find(',');
+         fields = comma == std::string_view::npos ? std::string_view() : fields.substr(comma + 1);
+      }
+      this->reply("ACK WP,1", this->profile_.reply_delay_ms);
+   } else if (line == "READ DEVINFO") {
+      this->reply("ACK READ DEVINFO:P500BU,PS21053C,V01", this->profile_.reply_delay_ms);
+   } else if (line == "READ LEARN STATUS") {
+      this->reply("ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0", this->profile_.reply_delay_ms);
+   } else if (line == "FULL OPEN") {
+      this->last_motion_command_at = this->now_;
+      this->start(1);
+   } else if (line == "FULL CLOSE") {
+      this->last_motion_command_at = this->now_;
+      this->start(-1);
+   } else if (line == "STOP") {
+      this->last_motion_command_at = this->now_;
+      if (this->phase_ == PHASE_RUNNING) {
+         this->phase_ = PHASE_STOPPING;
+         this->phase_at_ = this->now_ + this->profile_.stop_delay_ms;
+      } else if (this->phase_ == PHASE_STARTING) {
+         this->phase_ = PHASE_IDLE;
+         this->event("Stopped", this->profile_.stop_delay_ms);
+      }
+   }
+}
+
+void GateProEmulator::start(int dir) {
+   if ((dir > 0 && this->position_ >= 1.0f) || (dir < 0 && this->position_ <= 0.0f)) {
+      return;
+   }
+   // reversing goes through a standstill
+   if (this->dir_ != dir) {
+      this->velocity_ = 0.0f;
+   }
+   this->dir_ = dir;
+   this->phase_ = PHASE_STARTING;
+   this->phase_at_ = this->now_ + this->profile_.start_delay_ms;
+}
+
+void GateProEmulator::reply(const std::string &line, uint32_t delay) {
+   this->pending_.push_back({this->now_ + delay, line});
+}
+
+void GateProEmulator::event(const char *name, uint32_t delay) {
+   char buf[64];
+   snprintf(buf, sizeof(buf), "$V1PKF0,%u,%s;src=0001", ++this->events_, name);
+   this->reply(buf, delay);
+}
+
+void GateProEmulator::step(uint32_t now, std::string &out) {
+   if (!this->started_) {
+      this->now_ = now;
+      this->started_ = true;
+   }
+   const float dt = (now - this->now_) / 1000.0f;
+   this->now_ = now;
+
+   switch (this->phase_) {
+      case PHASE_STARTING:
+         if ((int32_t) (now - this->phase_at_) >= 0) {
+            this->phase_ = PHASE_RUNNING;
+            this->event(this->dir_ > 0 ? "Opening" : "Closing");
+         }
+         break;
+      case PHASE_STOPPING:
+      case PHASE_RUNNING:
+         this->velocity_ = std::min(this->profile_.speed,
+            this->velocity_ + this->profile_.speed * dt * 1000.0f / this->profile_.ramp_ms);
+         this->position_ += this->dir_ * this->velocity_ * dt;
+         if (this->phase_ == PHASE_STOPPING && (int32_t) (now - this->phase_at_) >= 0) {
+            this->phase_ = PHASE_BRAKING;
+            this->braking_left_ = this->profile_.coast;
+            this->event("Stopped");
+         }
+         break;
+      case PHASE_BRAKING: {
+         const float moved = std::min(this->velocity_ * dt, this->braking_left_);
+         this->position_ += this->dir_ * moved;
+         this->braking_left_ -= moved;
+         if (this->braking_left_ <= 0.0f) {
+            this->phase_ = PHASE_IDLE;
+            this->velocity_ = 0.0f;
+         }
+         break;
+      }
+      case PHASE_IDLE:
+         break;
+   }
+
+   // end stops
+   if (this->phase_ != PHASE_IDLE && this->phase_ != PHASE_STARTING) {
+      if (this->dir_ > 0 && this->position_ >= 1.0f) {
+         this->position_ = 1.0f;
+         this->phase_ = PHASE_IDLE;
+         this->velocity_ = 0.0f;
+         this->event("Opened");
+      } else if (this->dir_ < 0 && this->position_ <= 0.0f) {
+         this->position_ = 0.0f;
+         this->phase_ = PHASE_IDLE;
+         this->velocity_ = 0.0f;
+         this->event("Closed");
+      }
+   }
+
+   // due replies and events, in order
+   auto due_end = std::stable_partition(this->pending_.begin(), this->pending_.end(),
+      [now](const Pending &p) { return (int32_t) (now - p.due) >= 0; });
+   std::stable_sort(this->pending_.begin(), due_end, [](const Pending &a, const Pending &b) {
+      return (int32_t) (a.due - b.due) < 0;
+   });
+   for (auto it = this->pending_.begin(); it != due_end; ++it) {
+      out += it->line;
+      out += "\r\n";
+   }
+   this->pending_.erase(this->pending_.begin(), due_end);
+}
+
+}  // namespace gatepro_host
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gatepro_host {
+
+// how the simulated controller and its leaf behave, times in ms, distances and speeds in travel fractions
+struct GateProEmulatorProfile {
+   float speed{0.1f};              // full speed, per second (10 s end to end)
+   uint32_t ramp_ms{800};          // standstill -> full speed
+   uint32_t start_delay_ms{150};   // FULL OPEN / FULL CLOSE -> moving (Opening / Closing event)
+   uint32_t stop_delay_ms{250};    // STOP -> braking (Stopped event)
+   float coast{0.01f};             // distance covered while braking
+   uint32_t reply_delay_ms{40};    // request -> ACK
+};
+
+// TMT CHOW controller emulator: answers RS, RP / WP, READ DEVINFO, READ LEARN STATUS,
+// runs FULL OPEN / FULL CLOSE / STOP on a simulated leaf and reports it with $V1PKF0 events.
+// Fed with what the component writes (receive), advanced on the virtual clock (step),
+// its output is read back by the component's UART.
+class GateProEmulator {
+   public:
+      explicit GateProEmulator(GateProEmulatorProfile profile = {}) : profile_(profile) {}
+
+      void receive(const uint8_t *data, size_t len);
+      // a command from the controller's own remote / wall button, not recorded in commands
+      void remote(std::string_view line);
+      // move the leaf up to now, anything that became due is appended to out
+      void step(uint32_t now, std::string &out);
+
+      float position() const { return this->position_; }
+      void set_position(float position) { this->position_ = position; }
+      bool moving() const { return this->phase_ != PHASE_IDLE; }
+
+      uint8_t params[17]{1, 0, 0, 1, 2, 2, 0, 0, 0, 3, 0, 0, 3, 0, 0, 0, 0};
+      // false: RP goes unanswered (a controller that's busy or offline)
+      bool answer_params{true};
+      // every line received, without the source id
+      std::vector<std::string> commands;
+      // virtual time the last motion command (FULL OPEN / FULL CLOSE / STOP) arrived
+      uint32_t last_motion_command_at{0};
+
+   protected:
+      enum Phase : uint8_t { PHASE_IDLE, PHASE_STARTING, PHASE_RUNNING, PHASE_STOPPING, PHASE_BRAKING };
+
+      void handle(std::string_view line);
+      void reply(const std::string &line, uint32_t delay);
+      void event(const char *name, uint32_t delay = 0);
+      void start(int dir);
+
+      GateProEmulatorProfile profile_;
+      std::string line_;
+      struct Pending {
+         uint32_t due;
+         std::string line;
+      };
+      std::vector<Pending> pending_;
+      uint32_t now_{0};
+      bool started_{false};
+
+      Phase phase_{PHASE_IDLE};
+      int dir_{0};
+      float position_{0.0f};
+      float velocity_{0.0f};
+      float braking_left_{0.0f};
+      uint32_t phase_at_{0};  // when STARTING / STOPPING ends
+      uint32_t events_{0};
+};
+
+}  // namespace gatepro_host
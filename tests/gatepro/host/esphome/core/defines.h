@@ -0,0 +1,3 @@
+#pragma once
+// host build: everything GatePro needs from ESPHome lives in one header
+#include "esphome/host.h"
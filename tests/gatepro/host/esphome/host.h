@@ -0,0 +1,278 @@
+#pragma once
+// Just enough of the ESPHome API to build the GatePro component on a Linux host.
+// Time is virtual (see host::advance), the UART is a pair of byte queues wired to the emulator.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// the Arduino core provides a generic abs()
+using std::abs;
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+#endif
+
+namespace esphome {
+namespace host {
+// log lines at or below this level are printed (GATEPRO_HOST_LOG=<level> at run time)
+extern int log_level;
+void log(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+}  // namespace host
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
+#define LOG_BINARY_SENSOR(prefix, type, obj) (void) (obj)
+#define LOG_TEXT_SENSOR(prefix, type, obj) (void) (obj)
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+
+uint32_t millis();
+
+namespace host {
+// move the virtual clock forward
+void advance(uint32_t ms);
+}  // namespace host
+
+class Component {
+   public:
+      virtual ~Component() = default;
+      virtual void setup() {}
+      virtual void loop() {}
+      virtual void dump_config() {}
+      virtual float get_setup_priority() const { return 0.0f; }
+
+      // named timeouts, fired by run_timeouts() once their time has come
+      void set_timeout(const std::string &name, uint32_t ms, std::function<void()> &&f);
+      bool cancel_timeout(const std::string &name);
+      void run_timeouts();
+
+   private:
+      std::map<std::string, std::pair<uint32_t, std::function<void()>>> timeouts_;
+};
+
+class PollingComponent : public Component {
+   public:
+      virtual void update() = 0;
+      void set_update_interval(uint32_t ms) { this->update_interval_ = ms; }
+      uint32_t get_update_interval() const { return this->update_interval_; }
+
+   protected:
+      uint32_t update_interval_{500};
+};
+
+namespace setup_priority {
+const float DATA = 600.0f;
+}  // namespace setup_priority
+
+class EntityBase {
+   public:
+      uint32_t get_object_id_hash() const { return 0x6a7e9a70; }
+};
+
+template<typename... X> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+   public:
+      void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+      void call(Ts... args) {
+         for (auto &cb : this->callbacks_) cb(args...);
+      }
+
+   private:
+      std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+// a single in-memory slot, kept across GatePro instances to emulate a reboot
+class ESPPreferenceObject {
+   public:
+      template<typename T> bool save(const T *src);
+      template<typename T> bool load(T *dst);
+};
+
+namespace host {
+extern std::string preference_blob;
+}  // namespace host
+
+template<typename T> bool ESPPreferenceObject::save(const T *src) {
+   host::preference_blob.assign(reinterpret_cast<const char *>(src), sizeof(T));
+   return true;
+}
+
+template<typename T> bool ESPPreferenceObject::load(T *dst) {
+   if (host::preference_blob.size() != sizeof(T)) return false;
+   memcpy(dst, host::preference_blob.data(), sizeof(T));
+   return true;
+}
+
+class ESPPreferences {
+   public:
+      template<typename T> ESPPreferenceObject make_preference(uint32_t, bool = false) { return {}; }
+};
+extern ESPPreferences *global_preferences;
+
+namespace uart {
+enum UARTParityOptions { UART_CONFIG_PARITY_NONE, UART_CONFIG_PARITY_EVEN, UART_CONFIG_PARITY_ODD };
+
+class UARTDevice {
+   public:
+      int available();
+      bool read_array(uint8_t *data, size_t len);
+      bool read_byte(uint8_t *data);
+      void write_array(const uint8_t *data, size_t len);
+      void write_str(const char *str) { this->write_array(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+      void check_uart_settings(uint32_t, uint8_t = 1, UARTParityOptions = UART_CONFIG_PARITY_NONE, uint8_t = 8) {}
+};
+}  // namespace uart
+
+namespace host {
+// bytes on their way to the component / everything it wrote
+extern std::deque<uint8_t> uart_rx;
+extern std::function<void(const uint8_t *, size_t)> uart_tx;
+}  // namespace host
+
+namespace cover {
+enum CoverOperation : uint8_t {
+   COVER_OPERATION_IDLE = 0,
+   COVER_OPERATION_OPENING,
+   COVER_OPERATION_CLOSING,
+};
+const float COVER_OPEN = 1.0f;
+const float COVER_CLOSED = 0.0f;
+
+class CoverTraits {
+   public:
+      void set_is_assumed_state(bool) {}
+      void set_supports_position(bool) {}
+      void set_supports_tilt(bool) {}
+      void set_supports_toggle(bool) {}
+      void set_supports_stop(bool) {}
+};
+
+class Cover;
+class CoverCall {
+   public:
+      explicit CoverCall(Cover *cover) : cover_(cover) {}
+      CoverCall &set_command_stop() { this->stop_ = true; return *this; }
+      CoverCall &set_command_open() { this->position_ = COVER_OPEN; return *this; }
+      CoverCall &set_command_close() { this->position_ = COVER_CLOSED; return *this; }
+      CoverCall &set_position(float position) { this->position_ = position; return *this; }
+      void perform();
+      bool get_stop() const { return this->stop_; }
+      const optional<float> &get_position() const { return this->position_; }
+
+   protected:
+      Cover *cover_;
+      bool stop_{false};
+      optional<float> position_{};
+};
+
+class Cover : public EntityBase {
+   public:
+      float position{COVER_OPEN};
+      CoverOperation current_operation{COVER_OPERATION_IDLE};
+      CoverCall make_call() { return CoverCall(this); }
+      void publish_state(bool save = true);
+      virtual CoverTraits get_traits() = 0;
+      // every published state, for the scenarios to inspect
+      uint32_t publish_count{0};
+
+   protected:
+      friend class CoverCall;
+      virtual void control(const CoverCall &call) = 0;
+};
+}  // namespace cover
+
+namespace sensor {
+class Sensor : public EntityBase {
+   public:
+      void publish_state(float value) { this->state = value; this->has_state_ = true; }
+      bool has_state() const { return this->has_state_; }
+      float state{NAN};
+
+   protected:
+      bool has_state_{false};
+};
+}  // namespace sensor
+
+namespace binary_sensor {
+class BinarySensor : public EntityBase {
+   public:
+      void publish_state(bool value) { this->state = value; }
+      bool state{false};
+};
+}  // namespace binary_sensor
+
+namespace text_sensor {
+class TextSensor : public EntityBase {
+   public:
+      void publish_state(const std::string &value) { this->state = value; }
+      std::string state;
+};
+}  // namespace text_sensor
+
+namespace button {
+class Button : public EntityBase {
+   public:
+      void add_on_press_callback(std::function<void()> &&callback) { this->press_callback_.add(std::move(callback)); }
+      void press() { this->press_callback_.call(); }
+
+   protected:
+      CallbackManager<void()> press_callback_;
+};
+}  // namespace button
+
+// template numbers / switches are optimistic: a publish is what the frontend sees and reacts to
+namespace number {
+class Number : public EntityBase {
+   public:
+      void publish_state(float value) { this->state = value; this->state_callback_.call(value); }
+      void add_on_state_callback(std::function<void(float)> &&callback) { this->state_callback_.add(std::move(callback)); }
+      float state{NAN};
+
+   protected:
+      CallbackManager<void(float)> state_callback_;
+};
+}  // namespace number
+
+namespace switch_ {
+class Switch : public EntityBase {
+   public:
+      void publish_state(bool value) { this->state = value; this->state_callback_.call(value); }
+      void add_on_state_callback(std::function<void(bool)> &&callback) { this->state_callback_.add(std::move(callback)); }
+      bool state{false};
+
+   protected:
+      CallbackManager<void(bool)> state_callback_;
+};
+}  // namespace switch_
+
+}  // namespace esphome
@@ -0,0 +1,371 @@
+// Closed-loop host tests for the GatePro component: the real component code against the controller
+// emulator, on a virtual clock. Build and run with `make` in this directory.
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "gatepro.h"
+#include "gatepro_emulator.h"
+
+using namespace esphome;
+using gatepro_host::GateProEmulator;
+using gatepro_host::GateProEmulatorProfile;
+
+static int failures = 0;
+
+#define EXPECT(cond, ...) \
+   do { \
+      if (!(cond)) { \
+         printf("  FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+         printf(__VA_ARGS__); \
+         printf("\n"); \
+         failures++; \
+      } \
+   } while (0)
+
+// virtual time step: the main loop runs once per step, update() every update interval
+static const uint32_t STEP_MS = 5;
+static const uint32_t UPDATE_INTERVAL_MS = 500;
+
+// one gate: the component with its frontend entities, wired to an emulated controller
+struct Rig {
+   GateProEmulator emu;
+   gatepro::GatePro gate;
+   number::Number speed, decel_dist, decel_speed, max_amp;
+   switch_::Switch permalock;
+   text_sensor::TextSensor devinfo, learn_status;
+   uint32_t last_update{0};
+
+   explicit Rig(GateProEmulatorProfile profile = {}, float position = 0.0f) : emu(profile) {
+      host::uart_rx.clear();
+      host::uart_tx = [this](const uint8_t *data, size_t len) { this->emu.receive(data, len); };
+      std::string discard;
+      this->emu.set_position(position);
+      this->emu.step(millis(), discard);
+
+      this->gate.set_speed_slider(&this->speed);
+      this->gate.set_decel_dist_slider(&this->decel_dist);
+      this->gate.set_decel_speed_slider(&this->decel_speed);
+      this->gate.set_max_amp_slider(&this->max_amp);
+      this->gate.set_sw_permalock(&this->permalock);
+      this->gate.set_txt_devinfo(&this->devinfo);
+      this->gate.set_txt_learn_status(&this->learn_status);
+      this->gate.set_save_interval(1000);
+      this->gate.setup();
+      this->last_update = millis();
+   }
+
+   ~Rig() { host::uart_tx = nullptr; }
+
+   void tick() {
+      host::advance(STEP_MS);
+      std::string out;
+      this->emu.step(millis(), out);
+      host::uart_rx.insert(host::uart_rx.end(), out.begin(), out.end());
+      this->gate.loop();
+      this->gate.run_timeouts();
+      if (millis() - this->last_update >= UPDATE_INTERVAL_MS) {
+         this->last_update = millis();
+         this->gate.update();
+      }
+   }
+
+   void run(uint32_t ms) {
+      for (uint32_t t = 0; t < ms; t += STEP_MS) this->tick();
+   }
+
+   bool run_until(const std::function<bool()> &done, uint32_t timeout_ms) {
+      for (uint32_t t = 0; t < timeout_ms; t += STEP_MS) {
+         this->tick();
+         if (done()) return true;
+      }
+      return false;
+   }
+
+   bool at_rest() { return !this->emu.moving() && this->gate.current_operation == cover::COVER_OPERATION_IDLE; }
+
+   size_t count(const std::string &command) {
+      size_t n = 0;
+      for (auto &c : this->emu.commands) n += c.compare(0, command.size(), command) == 0;
+      return n;
+   }
+};
+
+static void feed(gatepro::GateProLineFramer &framer, const char *data) {
+   const size_t len = strlen(data);
+   const size_t space = framer.space();
+   const size_t n = len < space ? len : space;
+   memcpy(framer.tail(), data, n);
+   framer.commit(n);
+}
+
+static void test_framer() {
+   printf("framer\n");
+   gatepro::GateProLineFramer framer;
+   std::string_view frame;
+
+   feed(framer, "ACK WP,1\r\nACK RS:00,80");
+   EXPECT(framer.next(frame) && frame == "ACK WP,1", "got '%.*s'", (int) frame.size(), frame.data());
+   EXPECT(!framer.next(frame), "partial frame handed out");
+   // delimiter split across two reads
+   feed(framer, ",C4,B2,3E,16,FF,FF,FF\r");
+   EXPECT(!framer.next(frame), "frame without its \\n handed out");
+   feed(framer, "\n\r\n");
+   EXPECT(framer.next(frame) && frame == "ACK RS:00,80,C4,B2,3E,16,FF,FF,FF", "got '%.*s'", (int) frame.size(), frame.data());
+   EXPECT(framer.next(frame) && frame.empty(), "empty frame expected");
+
+   // a full buffer without a delimiter is dropped, the next frame still comes through
+   std::string garbage(GATEPRO_RX_BUFFER_SIZE, 'x');
+   feed(framer, garbage.c_str());
+   EXPECT(!framer.next(frame), "garbage handed out");
+   EXPECT(framer.overflows() == 1, "overflows %u", framer.overflows());
+   feed(framer, "ACK WP,1\r\n");
+   EXPECT(framer.next(frame) && frame == "ACK WP,1", "no resync after overflow");
+
+   // full buffer ending in '\r': waiting for its '\n' would never end, it's an overflow too
+   garbage.back() = '\r';
+   feed(framer, garbage.c_str());
+   EXPECT(!framer.next(frame), "garbage handed out");
+   EXPECT(framer.overflows() == 2, "overflows %u", framer.overflows());
+   EXPECT(framer.space() == GATEPRO_RX_BUFFER_SIZE - 1, "space %zu", framer.space());
+   feed(framer, "\nACK WP,1\r\n");
+   EXPECT(framer.next(frame) && frame.empty(), "the rest of the garbage should end as an empty frame");
+   EXPECT(framer.next(frame) && frame == "ACK WP,1", "no resync after overflow");
+}
+
+static void test_boot() {
+   printf("boot\n");
+   host::preference_blob.clear();
+   Rig rig({}, 0.42f);
+   rig.run(3000);
+   EXPECT(rig.speed.state == rig.emu.params[3], "speed %.0f, controller %u", rig.speed.state, rig.emu.params[3]);
+   EXPECT(rig.decel_dist.state == rig.emu.params[4], "decel dist %.0f", rig.decel_dist.state);
+   EXPECT(rig.decel_speed.state == rig.emu.params[5], "decel speed %.0f", rig.decel_speed.state);
+   EXPECT(rig.max_amp.state == rig.emu.params[6], "max amp %.0f", rig.max_amp.state);
+   EXPECT(rig.devinfo.state == "P500BU,PS21053C,V01", "devinfo '%s'", rig.devinfo.state.c_str());
+   EXPECT(std::abs(rig.gate.position - 0.42f) < 0.011f, "position %.3f", rig.gate.position);
+}
+
+static void test_param_write() {
+   printf("param write\n");
+   host::preference_blob.clear();
+   Rig rig;
+   rig.run(3000);
+   const size_t writes = rig.count("WP,1:");
+
+   // two sliders within the debounce window: one WP
+   rig.speed.publish_state(3);
+   rig.run(200);
+   rig.decel_dist.publish_state(1);
+   rig.run(3000);
+   EXPECT(rig.count("WP,1:") == writes + 1, "%zu writes", rig.count("WP,1:") - writes);
+   EXPECT(rig.emu.params[3] == 3 && rig.emu.params[4] == 1, "controller has %u / %u", rig.emu.params[3], rig.emu.params[4]);
+
+   // moved away and back within the window: nothing to write
+   rig.speed.publish_state(2);
+   rig.run(200);
+   rig.speed.publish_state(3);
+   rig.run(3000);
+   EXPECT(rig.count("WP,1:") == writes + 1, "%zu writes", rig.count("WP,1:") - writes);
+   EXPECT(rig.emu.params[3] == 3, "controller speed %u", rig.emu.params[3]);
+}
+
+// the read a slider change waits for gives up: the change is kept and written once RP comes back
+static void test_param_write_unanswered_read() {
+   printf("param write, RP unanswered\n");
+   host::preference_blob.clear();
+   Rig rig;
+   rig.emu.answer_params = false;
+   rig.run(3000);
+   rig.speed.publish_state(3);
+   rig.run(6000);
+   EXPECT(rig.count("WP,1:") == 0, "wrote without ever reading the params");
+
+   rig.emu.answer_params = true;
+   rig.run(6000);
+   EXPECT(rig.count("WP,1:") == 1, "%zu writes", rig.count("WP,1:"));
+   EXPECT(rig.emu.params[3] == 3, "controller speed %u", rig.emu.params[3]);
+   EXPECT(rig.speed.state == 3, "slider %.0f", rig.speed.state);
+}
+
+static void test_full_travel() {
+   printf("full travel\n");
+   host::preference_blob.clear();
+   Rig rig;
+   rig.run(2000);
+   for (float end : {cover::COVER_OPEN, cover::COVER_CLOSED}) {
+      const auto op = end == cover::COVER_OPEN ? cover::COVER_OPERATION_OPENING : cover::COVER_OPERATION_CLOSING;
+      const uint32_t called_at = millis();
+      rig.gate.make_call().set_position(end).perform();
+      // optimistic_operation shows the motion before the motor reports it
+      EXPECT(rig.run_until([&] { return rig.gate.current_operation == op; }, 2000), "never shown moving");
+      const uint32_t shown = millis() - called_at;
+      EXPECT(rig.run_until([&] { return rig.emu.moving(); }, 2000), "never started");
+      EXPECT(rig.run_until([&] { return rig.at_rest(); }, 15000), "never came to rest");
+      const uint32_t travel = millis() - called_at;
+      rig.run(1000);
+      printf("  %-7s shown moving after %u ms, at rest after %u ms\n", end == cover::COVER_OPEN ? "open" : "close",
+         shown, travel);
+      EXPECT(rig.emu.position() == end, "controller at %.3f", rig.emu.position());
+      EXPECT(rig.gate.position == end, "reported %.3f", rig.gate.position);
+   }
+}
+
+// requests within min_position_change of the current position don't move the gate
+static void test_min_position_change() {
+   printf("min position change\n");
+   host::preference_blob.clear();
+   Rig rig(GateProEmulatorProfile{}, 0.5f);
+   rig.gate.set_min_position_change(0.05f);
+   rig.run(3000);
+   rig.gate.make_call().set_position(0.53f).perform();
+   rig.run(2000);
+   EXPECT(rig.count("FULL OPEN") == 0 && !rig.emu.moving(), "moved for a 3%% change");
+   rig.gate.make_call().set_position(0.8f).perform();
+   EXPECT(rig.run_until([&] { return rig.emu.moving(); }, 2000), "never started");
+}
+
+// STOP from a remote mid-travel looks like a trip: it is reported, but the gate must not be restarted
+static void test_remote_stop() {
+   printf("remote stop\n");
+   host::preference_blob.clear();
+   Rig rig;
+   binary_sensor::BinarySensor obstruction;
+   rig.gate.set_obstruction_sensor(&obstruction);
+   rig.gate.set_obstruction_retries(2);
+   rig.gate.set_obstruction_retry_delay(1000);
+   rig.run(2000);
+   rig.gate.make_call().set_position(cover::COVER_OPEN).perform();
+   EXPECT(rig.run_until([&] { return rig.emu.position() > 0.3f; }, 8000), "never got going");
+   rig.emu.remote("STOP");
+   EXPECT(rig.run_until([&] { return rig.at_rest(); }, 3000), "never came to rest");
+   EXPECT(obstruction.state, "unexpected stop not reported");
+   const float stopped_at = rig.emu.position();
+   rig.run(5000);
+   EXPECT(rig.count("FULL OPEN") == 1, "restarted %zu times", rig.count("FULL OPEN") - 1);
+   EXPECT(rig.emu.position() == stopped_at, "moved from %.3f to %.3f", stopped_at, rig.emu.position());
+}
+
+// partial targets, one after the other: how close the leaf ends up, and how long a command takes to
+// reach the controller; the first run per direction has nothing learned yet.
+// With GATEPRO_FULL_TRAVEL a target only picks the direction, the leaf should end up at the end stop.
+static void bench_stop_accuracy() {
+   printf("stop accuracy\n");
+   host::preference_blob.clear();
+   Rig rig;
+   rig.run(2000);
+
+   static const float TARGETS[] = {0.5f, 0.2f, 0.7f, 0.4f, 0.6f, 0.3f, 0.8f, 0.5f};
+   printf("  %-7s %-8s %-8s %-8s %-8s %-8s\n", "target", "expect", "final", "error", "reported", "latency");
+   float worst_learned = 0.0f;
+   int run = 0;
+   for (float target : TARGETS) {
+#ifdef GATEPRO_FULL_TRAVEL
+      const float expected = target < rig.gate.position ? cover::COVER_CLOSED : cover::COVER_OPEN;
+#else
+      const float expected = target;
+#endif
+      const size_t commands = rig.emu.commands.size();
+      const uint32_t called_at = millis();
+      rig.gate.make_call().set_position(target).perform();
+      rig.run_until([&] { return rig.emu.commands.size() > commands && rig.emu.last_motion_command_at >= called_at; }, 2000);
+      const uint32_t latency = rig.emu.last_motion_command_at - called_at;
+      rig.run(500);
+      EXPECT(rig.run_until([&] { return rig.at_rest(); }, 15000), "never came to rest");
+      rig.run(1500);
+
+      const float error = rig.emu.position() - expected;
+      printf("  %-7.2f %-8.2f %-8.3f %+-8.3f %-8.3f %u ms\n", target, expected, rig.emu.position(), error,
+         rig.gate.position, latency);
+      if (run++ >= 2) worst_learned = std::max(worst_learned, std::abs(error));
+      // at rest, the component only follows changes of at least its acceptable_diff (5%)
+      EXPECT(std::abs(rig.gate.position - rig.emu.position()) < 0.05f, "reported %.3f, actual %.3f",
+         rig.gate.position, rig.emu.position());
+   }
+   printf("  worst error once learned: %.3f\n", worst_learned);
+   // status comes in 1% steps, 250 ms apart while approaching the target
+   EXPECT(worst_learned <= 0.03f, "worst error %.3f", worst_learned);
+}
+
+// a reboot with the leaf halfway: the restored position is published right away and kept
+static void test_reboot_restore() {
+   printf("reboot restore\n");
+   host::preference_blob.clear();
+   float position, actual;
+   {
+      Rig rig;
+      rig.run(2000);
+      rig.gate.make_call().set_position(0.6f).perform();
+      rig.run(500);
+      rig.run_until([&] { return rig.at_rest(); }, 15000);
+      rig.run(3000);
+      position = rig.gate.position;
+      actual = rig.emu.position();
+   }
+   EXPECT(!host::preference_blob.empty(), "nothing saved");
+
+   // no reply from the controller for a while, only the saved state counts
+   GateProEmulatorProfile slow;
+   slow.reply_delay_ms = 2000;
+   Rig rig(slow, actual);
+   EXPECT(std::abs(rig.gate.position - position) < 0.011f, "restored %.3f, saved %.3f", rig.gate.position, position);
+   rig.run(1500);
+   EXPECT(std::abs(rig.gate.position - position) < 0.011f, "after update() %.3f, saved %.3f", rig.gate.position, position);
+}
+
+// params restored from flash are stale until an RP confirms them, a slider change must not write them back
+static void test_param_write_after_restore() {
+   printf("param write after restore\n");
+   host::preference_blob.clear();
+   uint8_t saved[17];
+   {
+      Rig rig;
+      rig.run(3000);
+      std::copy(rig.emu.params, rig.emu.params + 17, saved);
+   }
+   EXPECT(!host::preference_blob.empty(), "nothing saved");
+
+   Rig rig;
+   // changed on the controller's own panel while we were down
+   std::copy(saved, saved + 17, rig.emu.params);
+   rig.emu.params[5] = saved[5] + 1;
+   rig.emu.answer_params = false;
+   rig.speed.publish_state(3);
+   rig.run(3000);
+   EXPECT(rig.count("WP,1:") == 0, "wrote the flash copy of the params");
+
+   rig.emu.answer_params = true;
+   rig.run(6000);
+   EXPECT(rig.count("WP,1:") == 1, "%zu writes", rig.count("WP,1:"));
+   EXPECT(rig.emu.params[3] == 3, "controller speed %u", rig.emu.params[3]);
+   EXPECT(rig.emu.params[5] == saved[5] + 1, "panel change overwritten, %u", rig.emu.params[5]);
+}
+
+int main() {
+   if (const char *level = getenv("GATEPRO_HOST_LOG")) {
+      host::log_level = atoi(level);
+   }
+#ifdef GATEPRO_FULL_TRAVEL
+   const char *position_mode = "full_travel";
+#else
+   const char *position_mode = "target";
+#endif
+#ifdef GATEPRO_OPTIMISTIC
+   const bool optimistic = true;
+#else
+   const bool optimistic = false;
+#endif
+   printf("position_mode: %s, optimistic_operation: %s\n", position_mode, optimistic ? "true" : "false");
+   test_framer();
+   test_boot();
+   test_param_write();
+   test_param_write_unanswered_read();
+   test_param_write_after_restore();
+   test_full_travel();
+   test_remote_stop();
+   test_min_position_change();
+   bench_stop_accuracy();
+   test_reboot_restore();
+   printf(failures ? "%d failure(s)\n" : "all passed\n", failures);
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,3 @@
+#pragma once
+// host build: everything Gree needs from ESPHome lives in one header
+#include "esphome/host.h"
@@ -0,0 +1,246 @@
+#pragma once
+// Just enough of the ESPHome API to build the Gree component on a Linux host.
+// Time is virtual (see host::advance), the UART is a pair of byte queues driven by the test.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+#endif
+
+namespace esphome {
+namespace host {
+// log lines at or below this level are printed (GREE_HOST_LOG=<level> at run time)
+extern int log_level;
+void log(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+}  // namespace host
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) esphome::host::log(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+
+uint32_t millis();
+
+namespace host {
+// move the virtual clock forward
+void advance(uint32_t ms);
+// bytes waiting for the component, and where its writes go
+extern std::deque<uint8_t> uart_rx;
+extern std::function<void(const uint8_t *, size_t)> uart_tx;
+}  // namespace host
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+
+  // named timeouts, fired by run_timeouts() once their time has come
+  void set_timeout(const std::string &name, uint32_t ms, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  void run_timeouts();
+
+ private:
+  std::map<std::string, std::pair<uint32_t, std::function<void()>>> timeouts_;
+};
+
+class PollingComponent : public Component {
+ public:
+  virtual void update() = 0;
+  void set_update_interval(uint32_t ms) { this->update_interval_ = ms; }
+  uint32_t get_update_interval() const { return this->update_interval_; }
+
+ protected:
+  uint32_t update_interval_{300};
+};
+
+class EntityBase {};
+
+template<typename... X> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &cb : this->callbacks_)
+      cb(args...);
+  }
+
+ private:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+namespace uart {
+enum UARTParityOptions { UART_CONFIG_PARITY_NONE, UART_CONFIG_PARITY_EVEN, UART_CONFIG_PARITY_ODD };
+
+class UARTDevice {
+ public:
+  int available();
+  bool read_array(uint8_t *data, size_t len);
+  void write_array(const uint8_t *data, size_t len);
+  void check_uart_settings(uint32_t baud_rate, uint8_t stop_bits, UARTParityOptions parity, uint8_t data_bits) {
+    (void) baud_rate, (void) stop_bits, (void) parity, (void) data_bits;
+  }
+};
+}  // namespace uart
+
+namespace sensor {
+class Sensor : public EntityBase {
+ public:
+  void publish_state(float value) {
+    this->state = value;
+    this->publish_count++;
+  }
+  bool has_state() const { return this->publish_count > 0; }
+  float state{NAN};
+  uint32_t publish_count{0};
+};
+}  // namespace sensor
+
+namespace climate {
+enum ClimateMode : uint8_t {
+  CLIMATE_MODE_OFF,
+  CLIMATE_MODE_HEAT_COOL,
+  CLIMATE_MODE_COOL,
+  CLIMATE_MODE_HEAT,
+  CLIMATE_MODE_FAN_ONLY,
+  CLIMATE_MODE_DRY,
+  CLIMATE_MODE_AUTO,
+};
+enum ClimateFanMode : uint8_t {
+  CLIMATE_FAN_ON,
+  CLIMATE_FAN_OFF,
+  CLIMATE_FAN_AUTO,
+  CLIMATE_FAN_LOW,
+  CLIMATE_FAN_MEDIUM,
+  CLIMATE_FAN_HIGH,
+  CLIMATE_FAN_MIDDLE,
+  CLIMATE_FAN_FOCUS,
+  CLIMATE_FAN_DIFFUSE,
+  CLIMATE_FAN_QUIET,
+};
+enum ClimateSwingMode : uint8_t {
+  CLIMATE_SWING_OFF,
+  CLIMATE_SWING_BOTH,
+  CLIMATE_SWING_VERTICAL,
+  CLIMATE_SWING_HORIZONTAL,
+};
+enum ClimatePreset : uint8_t {
+  CLIMATE_PRESET_NONE,
+  CLIMATE_PRESET_HOME,
+  CLIMATE_PRESET_AWAY,
+  CLIMATE_PRESET_BOOST,
+  CLIMATE_PRESET_COMFORT,
+  CLIMATE_PRESET_ECO,
+  CLIMATE_PRESET_SLEEP,
+  CLIMATE_PRESET_ACTIVITY,
+};
+
+// only stores what it's told, nothing reads it back on the host
+class ClimateTraits {
+ public:
+  void set_visual_min_temperature(float) {}
+  void set_visual_max_temperature(float) {}
+  void set_visual_temperature_step(float) {}
+  void set_supported_modes(std::set<ClimateMode>) {}
+  void set_supported_fan_modes(std::set<ClimateFanMode>) {}
+  void set_supported_swing_modes(std::set<ClimateSwingMode>) {}
+  void set_supports_current_temperature(bool) {}
+  void set_supports_two_point_target_temperature(bool) {}
+  void set_supported_presets(std::set<ClimatePreset>) {}
+  void add_supported_preset(ClimatePreset) {}
+};
+
+class Climate;
+
+class ClimateCall {
+ public:
+  explicit ClimateCall(Climate *parent) : parent_(parent) {}
+  ClimateCall &set_mode(ClimateMode mode) {
+    this->mode_ = mode;
+    return *this;
+  }
+  ClimateCall &set_target_temperature(float temperature) {
+    this->target_temperature_ = temperature;
+    return *this;
+  }
+  ClimateCall &set_fan_mode(ClimateFanMode fan_mode) {
+    this->fan_mode_ = fan_mode;
+    return *this;
+  }
+  ClimateCall &set_swing_mode(ClimateSwingMode swing_mode) {
+    this->swing_mode_ = swing_mode;
+    return *this;
+  }
+  ClimateCall &set_preset(ClimatePreset preset) {
+    this->preset_ = preset;
+    return *this;
+  }
+  void perform();
+
+  const optional<ClimateMode> &get_mode() const { return this->mode_; }
+  const optional<float> &get_target_temperature() const { return this->target_temperature_; }
+  const optional<ClimateFanMode> &get_fan_mode() const { return this->fan_mode_; }
+  const optional<ClimateSwingMode> &get_swing_mode() const { return this->swing_mode_; }
+  const optional<ClimatePreset> &get_preset() const { return this->preset_; }
+
+ protected:
+  Climate *parent_;
+  optional<ClimateMode> mode_;
+  optional<float> target_temperature_;
+  optional<ClimateFanMode> fan_mode_;
+  optional<ClimateSwingMode> swing_mode_;
+  optional<ClimatePreset> preset_;
+};
+
+class Climate : public EntityBase {
+ public:
+  virtual ~Climate() = default;
+  ClimateCall make_call() { return ClimateCall(this); }
+  void publish_state() { this->publish_count++; }
+  virtual void control(const ClimateCall &call) = 0;
+
+  ClimateMode mode{CLIMATE_MODE_OFF};
+  optional<ClimateFanMode> fan_mode;
+  ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+  optional<ClimatePreset> preset;
+  float target_temperature{NAN};
+  float current_temperature{NAN};
+  uint32_t publish_count{0};
+
+ protected:
+  virtual ClimateTraits traits() = 0;
+  void dump_traits_(const char *tag) { (void) tag; }
+};
+}  // namespace climate
+
+}  // namespace esphome
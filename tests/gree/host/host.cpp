@@ -0,0 +1,70 @@
+#include <cstdarg>
+#include "esphome/host.h"
+
+namespace esphome {
+
+namespace host {
+int log_level = ESPHOME_LOG_LEVEL_WARN;
+std::deque<uint8_t> uart_rx;
+std::function<void(const uint8_t *, size_t)> uart_tx;
+
+static uint32_t now_ms = 1000;
+
+void advance(uint32_t ms) { now_ms += ms; }
+
+void log(int level, const char *tag, const char *format, ...) {
+  if (level > log_level)
+    return;
+  printf("[%8u][%s] ", now_ms, tag);
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  printf("\n");
+}
+}  // namespace host
+
+uint32_t millis() { return host::now_ms; }
+
+void Component::set_timeout(const std::string &name, uint32_t ms, std::function<void()> &&f) {
+  this->timeouts_[name] = {millis() + ms, std::move(f)};
+}
+
+bool Component::cancel_timeout(const std::string &name) { return this->timeouts_.erase(name) > 0; }
+
+void Component::run_timeouts() {
+  for (auto it = this->timeouts_.begin(); it != this->timeouts_.end();) {
+    if ((int32_t) (millis() - it->second.first) >= 0) {
+      auto f = std::move(it->second.second);
+      it = this->timeouts_.erase(it);
+      f();
+    } else {
+      ++it;
+    }
+  }
+}
+
+namespace uart {
+int UARTDevice::available() { return host::uart_rx.size(); }
+
+bool UARTDevice::read_array(uint8_t *data, size_t len) {
+  if (host::uart_rx.size() < len)
+    return false;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = host::uart_rx.front();
+    host::uart_rx.pop_front();
+  }
+  return true;
+}
+
+void UARTDevice::write_array(const uint8_t *data, size_t len) {
+  if (host::uart_tx)
+    host::uart_tx(data, len);
+}
+}  // namespace uart
+
+namespace climate {
+void ClimateCall::perform() { this->parent_->control(*this); }
+}  // namespace climate
+
+}  // namespace esphome
@@ -0,0 +1,200 @@
+// Host tests for the Gree component: the frame parser on a noisy, chunked byte stream, and control()
+// coalescing / command confirmation against scripted unit reports, on a virtual clock.
+// Build and run with `make` in this directory.
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "gree.h"
+
+using namespace esphome;
+
+static int failures = 0;
+
+#define EXPECT(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("  FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      failures++; \
+    } \
+  } while (0)
+
+using Bytes = std::vector<uint8_t>;
+
+static const uint32_t STEP_MS = 10;
+static const uint8_t FORCE_UPDATE_ON = 175;
+
+// 0x31 report as the unit sends it: 47 data bytes, checksum over everything after the start bytes
+static Bytes report(uint8_t mode_fan, uint8_t temperature, uint8_t swing = gree::AC_SWING_OFF, uint8_t indoor = 62) {
+  Bytes frame(50, 0);
+  frame[0] = frame[1] = GREE_START_BYTE;
+  frame[2] = 47;
+  frame[3] = gree::GREE_PACKET_REPORT;
+  frame[8] = mode_fan;
+  frame[9] = temperature;
+  frame[12] = swing;
+  frame[46] = indoor;
+  for (size_t i = 2; i < frame.size() - 1; i++)
+    frame.back() += frame[i];
+  return frame;
+}
+
+static void append(Bytes &stream, const Bytes &bytes) { stream.insert(stream.end(), bytes.begin(), bytes.end()); }
+
+// the whole stream through the parser, `chunk` bytes per read as far as space() allows
+static std::vector<Bytes> parse(gree::GreeFrameParser &parser, const Bytes &stream, size_t chunk) {
+  std::vector<Bytes> frames;
+  for (size_t pos = 0; pos < stream.size();) {
+    const size_t len = std::min({chunk, parser.space(), stream.size() - pos});
+    memcpy(parser.tail(), stream.data() + pos, len);
+    parser.commit(len);
+    pos += len;
+    const uint8_t *frame;
+    uint8_t size;
+    while (parser.next(frame, size))
+      frames.emplace_back(frame, frame + size);
+  }
+  return frames;
+}
+
+static void test_parser() {
+  printf("frame parser\n");
+  const Bytes a = report(gree::AC_MODE_COOL | gree::AC_FAN_LOW, 0x60);
+  const Bytes b = report(gree::AC_MODE_HEAT | gree::AC_FAN_AUTO, 0x80);
+  const Bytes d = report(gree::AC_MODE_OFF, 0x40);
+  const Bytes e = report(gree::AC_MODE_DRY | gree::AC_FAN_LOW, 0x50, gree::AC_SWING_BOTH);
+  Bytes c = report(gree::AC_MODE_AUTO, 0x70);
+  c.back() ^= 0x01;
+
+  Bytes stream;
+  // line noise: 5 resync bytes
+  append(stream, {0x00, 0x11, 0x22, 0x33, 0x44});
+  append(stream, a);
+  // false header with an impossible length: 3 resync bytes
+  append(stream, {GREE_START_BYTE, GREE_START_BYTE, 0x01});
+  append(stream, b);
+  // corrupted frame: 1 bad checksum, all 50 bytes resynced
+  append(stream, c);
+  append(stream, d);
+  // a frame cut short, its header claims the start of the next one: 1 bad checksum, 5 resync bytes
+  append(stream, {GREE_START_BYTE, GREE_START_BYTE, 47, gree::GREE_PACKET_REPORT, 0x00});
+  append(stream, e);
+
+  // how the stream is split up must not matter
+  for (size_t chunk : {(size_t) 1, (size_t) 3, (size_t) 7, (size_t) 49, (size_t) 64, stream.size()}) {
+    gree::GreeFrameParser parser;
+    const auto frames = parse(parser, stream, chunk);
+    EXPECT(frames.size() == 4, "%zu byte chunks: %zu frames", chunk, frames.size());
+    if (frames.size() == 4) {
+      EXPECT(frames[0] == a && frames[1] == b && frames[2] == d && frames[3] == e, "%zu byte chunks: wrong frames",
+             chunk);
+    }
+    EXPECT(parser.bad_checksums() == 2, "%zu byte chunks: %u bad checksums", chunk, parser.bad_checksums());
+    EXPECT(parser.resync_bytes() == 5 + 3 + 50 + 5, "%zu byte chunks: %u resync bytes", chunk,
+           parser.resync_bytes());
+  }
+}
+
+// one unit: the component with its diagnostic sensors, fed reports by the test
+struct Rig {
+  gree::GreeClimate climate;
+  sensor::Sensor merged, confirm_latency, confirm_failures;
+  // set frames sent with force_update, i.e. commands rather than polls
+  std::vector<Bytes> commands;
+
+  Rig() {
+    host::uart_rx.clear();
+    this->climate.set_merged_sensor(&this->merged);
+    this->climate.set_confirm_latency_sensor(&this->confirm_latency);
+    this->climate.set_confirm_failures_sensor(&this->confirm_failures);
+    this->climate.add_on_frame_callback([this](bool tx, const uint8_t *data, size_t size) {
+      if (tx && data[7] == FORCE_UPDATE_ON)
+        this->commands.emplace_back(data, data + size);
+    });
+  }
+
+  void receive(const Bytes &frame) { host::uart_rx.insert(host::uart_rx.end(), frame.begin(), frame.end()); }
+
+  // the unit reports `frame` every 500 ms while the clock runs
+  void run(uint32_t ms, const Bytes &frame) {
+    for (uint32_t t = 0; t < ms; t += STEP_MS) {
+      if (t % 500 == 0)
+        this->receive(frame);
+      host::advance(STEP_MS);
+      this->climate.loop();
+      this->climate.run_timeouts();
+    }
+  }
+};
+
+// a scene setting mode, temperature and fan one call at a time goes out as one frame
+static void test_coalescing() {
+  printf("control coalescing\n");
+  Rig rig;
+  const Bytes idle = report(gree::AC_MODE_OFF, 0x40);
+  rig.run(1000, idle);
+  rig.climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  rig.run(50, idle);
+  rig.climate.make_call().set_target_temperature(22).perform();
+  rig.run(50, idle);
+  rig.climate.make_call().set_fan_mode(climate::CLIMATE_FAN_HIGH).perform();
+  rig.run(200, idle);
+  EXPECT(rig.commands.size() == 1, "%zu commands", rig.commands.size());
+  if (!rig.commands.empty()) {
+    const Bytes &sent = rig.commands.front();
+    EXPECT(sent[8] == (gree::AC_MODE_COOL | gree::AC_FAN_HIGH), "mode / fan 0x%02X", sent[8]);
+    EXPECT(sent[9] == (22 - 16) * 16, "temperature 0x%02X", sent[9]);
+  }
+  rig.climate.update();
+  EXPECT(rig.merged.state == 2, "%.0f merged calls", rig.merged.state);
+
+  // without a window every call is sent right away
+  Rig direct;
+  direct.climate.set_control_window(0);
+  direct.run(1000, idle);
+  direct.climate.make_call().set_mode(climate::CLIMATE_MODE_HEAT).perform();
+  direct.climate.make_call().set_target_temperature(25).perform();
+  EXPECT(direct.commands.size() == 2, "%zu commands", direct.commands.size());
+}
+
+// a command the reports don't reflect is resent with backoff until the confirm timeout,
+// one they do reflect is confirmed and not resent
+static void test_confirm() {
+  printf("command confirmation\n");
+  Rig rig;
+  const Bytes idle = report(gree::AC_MODE_OFF, 0x40);
+  rig.run(1000, idle);
+  rig.climate.make_call().set_mode(climate::CLIMATE_MODE_HEAT).set_target_temperature(24).perform();
+  // the unit ignores it: sent, then resent after 1 s, 2 s and 4 s more, given up at 10 s
+  rig.run(12000, idle);
+  EXPECT(rig.commands.size() == 4, "%zu sends", rig.commands.size());
+  rig.climate.update();
+  EXPECT(rig.confirm_failures.state == 1, "%.0f confirm failures", rig.confirm_failures.state);
+  EXPECT(!rig.confirm_latency.has_state(), "confirmed %.0f ms", rig.confirm_latency.state);
+  // given up: the reports are followed again
+  EXPECT(rig.climate.mode == climate::CLIMATE_MODE_OFF, "mode %d", (int) rig.climate.mode);
+
+  rig.commands.clear();
+  rig.climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).set_fan_mode(climate::CLIMATE_FAN_LOW).perform();
+  rig.run(500, idle);
+  EXPECT(rig.commands.size() == 1, "%zu sends", rig.commands.size());
+  rig.run(5000, report(gree::AC_MODE_COOL | gree::AC_FAN_LOW, 0x40));
+  EXPECT(rig.commands.size() == 1, "resent after being confirmed, %zu sends", rig.commands.size());
+  EXPECT(rig.confirm_latency.has_state(), "never confirmed");
+  EXPECT(rig.climate.mode == climate::CLIMATE_MODE_COOL, "mode %d", (int) rig.climate.mode);
+  rig.climate.update();
+  EXPECT(rig.confirm_failures.state == 1, "%.0f confirm failures", rig.confirm_failures.state);
+}
+
+int main() {
+  if (const char *level = getenv("GREE_HOST_LOG")) {
+    host::log_level = atoi(level);
+  }
+  test_parser();
+  test_coalescing();
+  test_confirm();
+  printf(failures ? "%d failure(s)\n" : "all passed\n", failures);
+  return failures ? 1 : 0;
+}